@@ -0,0 +1,70 @@
+/**
+* @file bench.h
+* @author Ilija Poznic
+* @date 2025
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace pie::bench {
+    using Clock = std::chrono::steady_clock;
+
+    struct Result {
+        std::string name;
+        std::vector<std::pair<std::string, double> > values{};
+
+        void add(const std::string &key, double value) {
+            values.emplace_back(key, value);
+        }
+    };
+
+    using Benchmark = std::function<void(std::vector<Result> &results)>;
+
+    /**
+     * Register benchmark, used from static initializers of bench_*.cpp files
+     * @return always true
+     */
+    bool register_benchmark(const std::string &name, Benchmark benchmark);
+
+    inline double to_us(Clock::duration duration) {
+        return std::chrono::duration<double, std::micro>(duration).count();
+    }
+
+    /**
+     * @param samples - will be sorted
+     * @param p - percentile in range [0, 100]
+     */
+    inline double percentile(std::vector<double> &samples, double p) {
+        if (samples.empty())
+            return 0.0;
+
+        std::sort(samples.begin(), samples.end());
+        auto index = static_cast<size_t>(p / 100.0 * static_cast<double>(samples.size() - 1));
+        return samples[index];
+    }
+
+    /**
+     * Add p50/p99/max of latency samples (in microseconds) to result
+     */
+    inline void add_latency(Result &result, std::vector<double> &samples_us) {
+        result.add("samples", static_cast<double>(samples_us.size()));
+        result.add("p50_us", percentile(samples_us, 50));
+        result.add("p99_us", percentile(samples_us, 99));
+        result.add("max_us", samples_us.empty() ? 0.0 : samples_us.back());
+    }
+
+    /**
+     * Prevent compiler from optimizing away value
+     */
+    template<typename T>
+    inline void do_not_optimize(T const &value) {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+}
@@ -0,0 +1,175 @@
+/**
+* @file bench_concurrent_queue.cpp
+* @author Ilija Poznic
+* @date 2025
+*
+* Many producers / single consumer throughput of ConcurrentQueue vs previous std::queue + std::shared_mutex queue.
+* BoundedQueue DropOldest with stalled consumer checks depth never exceeds capacity (max_depth, over_capacity).
+*/
+
+#include "bench.h"
+
+#include "pie/concurrent/BoundedQueue.h"
+#include "pie/concurrent/ConcurrentQueue.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <memory>
+#include <queue>
+#include <shared_mutex>
+#include <thread>
+
+namespace {
+    /**
+     * Previous pie::concurrent::ConcurrentQueue implementation
+     */
+    template<typename Value>
+    class LockedQueue {
+    public:
+        void push(const Value &value) {
+            auto locker = lock();
+            queue.push(value);
+        }
+
+        std::optional<Value> try_pop() {
+            if (empty())
+                return std::nullopt;
+
+            auto locker = lock();
+            auto value = queue.front();
+            queue.pop();
+            return value;
+        }
+
+        bool empty() {
+            auto locker = lock();
+            return queue.empty();
+        }
+
+    private:
+        std::unique_lock<std::shared_mutex> lock() {
+            while (true) {
+                try {
+                    return std::unique_lock<std::shared_mutex>(mutex);
+                } catch (...) {
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+
+        std::queue<Value> queue{};
+        std::shared_mutex mutex{};
+    };
+
+    using Item = std::shared_ptr<int>;
+
+    template<typename Queue>
+    void run(const std::string &name, size_t producers, std::vector<pie::bench::Result> &results) {
+        constexpr size_t items_per_producer = 100000;
+        Queue queue{};
+        std::atomic<bool> start{false};
+        std::vector<std::thread> threads{};
+        for (size_t p = 0; p < producers; ++p) {
+            threads.emplace_back([&] {
+                auto item = std::make_shared<int>(0);
+                while (!start)
+                    std::this_thread::yield();
+
+                for (size_t i = 0; i < items_per_producer; ++i)
+                    queue.push(item);
+            });
+        }
+
+        auto total = producers * items_per_producer;
+        size_t popped{0};
+        auto begin = pie::bench::Clock::now();
+        start = true;
+        while (popped < total) {
+            if (queue.try_pop())
+                ++popped;
+        }
+
+        auto elapsed = pie::bench::Clock::now() - begin;
+        for (auto &thread: threads)
+            thread.join();
+
+        pie::bench::Result result{name + "/producers:" + std::to_string(producers)};
+        result.add("items", static_cast<double>(total));
+        result.add("mops_per_s", static_cast<double>(total) / pie::bench::to_us(elapsed));
+        results.emplace_back(std::move(result));
+    }
+
+    /**
+     * Producers flood DropOldest queue while consumer is stalled, then consumer drains it.
+     * Depth is sampled during the flood, survivors must be the newest values of every producer.
+     */
+    void run_drop_oldest_stalled(size_t producers, std::vector<pie::bench::Result> &results) {
+        constexpr size_t capacity = 1024;
+        constexpr size_t items_per_producer = 100000;
+        std::atomic<uint64_t> on_dropped{0};
+        pie::concurrent::BoundedQueue<std::pair<size_t, size_t> > queue{
+            capacity, pie::concurrent::OverflowPolicy::DropOldest, [&on_dropped](std::pair<size_t, size_t> &&) {
+                on_dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+        };
+
+        std::atomic<size_t> running{producers};
+        std::vector<std::thread> threads{};
+        auto begin = pie::bench::Clock::now();
+        for (size_t p = 0; p < producers; ++p) {
+            threads.emplace_back([&queue, &running, p] {
+                for (size_t i = 0; i < items_per_producer; ++i)
+                    queue.push({p, i}, std::chrono::steady_clock::now());
+
+                --running;
+            });
+        }
+
+        size_t max_depth{0};
+        while (running.load() > 0)
+            max_depth = std::max(max_depth, queue.depth());
+
+        auto elapsed = pie::bench::Clock::now() - begin;
+        for (auto &thread: threads)
+            thread.join();
+
+        std::vector<size_t> last(producers, 0);
+        size_t out_of_order{0};
+        auto drained = queue.pop_all([&](std::pair<size_t, size_t> &&value) {
+            auto [producer, index] = value;
+            if (index < last[producer])
+                ++out_of_order;
+
+            last[producer] = index;
+        });
+
+        auto total = producers * items_per_producer;
+        auto over_capacity = std::max(max_depth, queue.high_water_mark()) > capacity;
+        if (over_capacity || drained + queue.dropped() != total || on_dropped.load() != queue.dropped() ||
+            out_of_order != 0)
+            std::cerr << "bounded_queue/drop_oldest_stalled: FAILED, queue exceeded capacity or lost values"
+                    << std::endl;
+
+        pie::bench::Result result{"bounded_queue/drop_oldest_stalled/producers:" + std::to_string(producers)};
+        result.add("capacity", static_cast<double>(capacity));
+        result.add("max_depth", static_cast<double>(std::max(max_depth, queue.high_water_mark())));
+        result.add("over_capacity", over_capacity ? 1 : 0);
+        result.add("drained", static_cast<double>(drained));
+        result.add("dropped", static_cast<double>(queue.dropped()));
+        result.add("out_of_order", static_cast<double>(out_of_order));
+        result.add("mops_per_s", static_cast<double>(total) / pie::bench::to_us(elapsed));
+        results.emplace_back(std::move(result));
+    }
+
+    const bool registered = pie::bench::register_benchmark(
+        "concurrent_queue", [](std::vector<pie::bench::Result> &results) {
+            for (size_t producers: {1, 2, 4, 8, 16}) {
+                run<LockedQueue<Item> >("concurrent_queue/locked", producers, results);
+                run<pie::concurrent::ConcurrentQueue<Item> >("concurrent_queue/mpsc", producers, results);
+            }
+
+            for (size_t producers: {1, 4, 16})
+                run_drop_oldest_stalled(producers, results);
+        });
+}
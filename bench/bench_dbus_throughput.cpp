@@ -0,0 +1,262 @@
+/**
+* @file bench_dbus_throughput.cpp
+* @author Ilija Poznic
+* @date 2025
+*
+* Messages per second through pie::dbus::DBus on private dbus-daemon with stand-in peer
+* that replies to every method call immediately, except "Slow" calls answered after slow_delay.
+* call_async_slow checks round trips keep flowing while slow calls are pending.
+*/
+
+#include "bench.h"
+#include "dbus_daemon.h"
+
+#include "pie/dbus/DBus.h"
+
+#include <atomic>
+#include <deque>
+#include <iostream>
+#include <thread>
+
+namespace {
+    const char *peer_name = "rs.pie.bench.Peer";
+    const char *peer_path = "/rs/pie/bench/peer";
+    const char *peer_iface = "rs.pie.bench.Peer";
+    constexpr auto slow_delay = 1000ms;
+
+    class NullLogger : public pie::Logger {
+    public:
+        void log(pie::LogLevel, std::string) override {
+        }
+    };
+
+    /**
+     * Replies to method calls, "Slow" calls after slow_delay without blocking other calls, counts received signals
+     */
+    class Peer {
+    public:
+        explicit Peer(const std::string &address) {
+            DBusError error{};
+            dbus_error_init(&error);
+            conn = dbus_connection_open_private(address.c_str(), &error);
+            if (!conn || !dbus_bus_register(conn, &error))
+                throw std::runtime_error("peer failed to connect");
+
+            dbus_bus_request_name(conn, peer_name, DBUS_NAME_FLAG_DO_NOT_QUEUE, &error);
+            dbus_error_free(&error);
+            thread = std::thread([this] {
+                while (running) {
+                    dbus_connection_read_write(conn, 10);
+                    while (!slow_calls.empty() && slow_calls.front().first <= std::chrono::steady_clock::now()) {
+                        auto reply = dbus_message_new_method_return(slow_calls.front().second);
+                        dbus_connection_send(conn, reply, nullptr);
+                        dbus_message_unref(reply);
+                        dbus_message_unref(slow_calls.front().second);
+                        slow_calls.pop_front();
+                    }
+
+                    while (auto msg = dbus_connection_pop_message(conn)) {
+                        if (dbus_message_is_method_call(msg, peer_iface, "Slow")) {
+                            slow_calls.emplace_back(std::chrono::steady_clock::now() + slow_delay, msg);
+                            continue;
+                        }
+
+                        if (dbus_message_get_type(msg) == DBUS_MESSAGE_TYPE_METHOD_CALL) {
+                            auto reply = dbus_message_new_method_return(msg);
+                            dbus_connection_send(conn, reply, nullptr);
+                            dbus_message_unref(reply);
+                        } else if (dbus_message_is_signal(msg, peer_iface, "Tick")) {
+                            ++signals;
+                        }
+
+                        dbus_message_unref(msg);
+                    }
+                }
+            });
+        }
+
+        ~Peer() {
+            running = false;
+            thread.join();
+            for (auto &[deadline, msg]: slow_calls)
+                dbus_message_unref(msg);
+
+            dbus_connection_close(conn);
+            dbus_connection_unref(conn);
+        }
+
+        std::atomic<uint64_t> signals{0};
+
+    private:
+        DBusConnection *conn{nullptr};
+        std::atomic<bool> running{true};
+        // calls to reply at deadline, used only by peer thread
+        std::deque<std::pair<std::chrono::steady_clock::time_point, DBusMessage *> > slow_calls{};
+        std::thread thread;
+    };
+
+    std::shared_ptr<DBusMessage> new_call(std::string method = "Echo") {
+        std::string bus_name{peer_name}, path{peer_path}, iface{peer_iface};
+        return pie::dbus::DBus::new_message(bus_name, path, iface, method);
+    }
+
+    std::shared_ptr<DBusMessage> new_signal() {
+        auto msg_p = dbus_message_new_signal(peer_path, peer_iface, "Tick");
+        dbus_message_set_destination(msg_p, peer_name);
+        return {msg_p, [](DBusMessage *msg) { dbus_message_unref(msg); }};
+    }
+
+    void add_rate(pie::bench::Result &result, size_t cnt, pie::bench::Clock::duration elapsed) {
+        result.add("messages", static_cast<double>(cnt));
+        result.add("msgs_per_s", static_cast<double>(cnt) / (pie::bench::to_us(elapsed) / 1e6));
+    }
+
+    void send_signals(pie::dbus::DBus &dbus, Peer &peer, std::vector<pie::bench::Result> &results) {
+        constexpr size_t producers = 4;
+        constexpr size_t per_producer = 5000;
+        auto signals_before = peer.signals.load();
+        std::atomic<size_t> failed{0};
+        std::vector<std::thread> threads{};
+        auto start = pie::bench::Clock::now();
+        for (size_t p = 0; p < producers; ++p) {
+            threads.emplace_back([&] {
+                for (size_t i = 0; i < per_producer; ++i) {
+                    if (dbus.send(new_signal(), 1000ms).code != pie::dbus::DBusResultCode::Success)
+                        ++failed;
+                }
+            });
+        }
+
+        for (auto &thread: threads)
+            thread.join();
+
+        auto elapsed = pie::bench::Clock::now() - start;
+        auto total = producers * per_producer;
+        while (peer.signals.load() - signals_before < total - failed && pie::bench::Clock::now() - start < 5s)
+            std::this_thread::sleep_for(1ms);
+
+        pie::bench::Result result{"dbus_throughput/send_signal"};
+        add_rate(result, total, elapsed);
+        result.add("failed", static_cast<double>(failed));
+        result.add("received_by_peer", static_cast<double>(peer.signals.load() - signals_before));
+        results.emplace_back(std::move(result));
+    }
+
+    void call_async(pie::dbus::DBus &dbus, std::vector<pie::bench::Result> &results) {
+        constexpr size_t total = 20000;
+        constexpr size_t window = 256;
+        std::atomic<size_t> in_flight{0};
+        std::atomic<size_t> completed{0};
+        std::atomic<size_t> failed{0};
+        auto start = pie::bench::Clock::now();
+        for (size_t i = 0; i < total; ++i) {
+            while (in_flight.load() >= window)
+                std::this_thread::yield();
+
+            ++in_flight;
+            dbus.call_async(new_call(), [&](const pie::dbus::DBusResult &result, std::shared_ptr<DBusMessage>) {
+                if (result.code != pie::dbus::DBusResultCode::Success)
+                    ++failed;
+
+                ++completed;
+                --in_flight;
+            }, 1000ms);
+        }
+
+        while (completed.load() < total)
+            std::this_thread::yield();
+
+        pie::bench::Result result{"dbus_throughput/call_async"};
+        add_rate(result, total, pie::bench::Clock::now() - start);
+        result.add("window", window);
+        result.add("failed", static_cast<double>(failed));
+        results.emplace_back(std::move(result));
+    }
+
+    /**
+     * Round trip latency while 100 calls to slow peer are pending, they must not hold up other traffic
+     */
+    void call_async_slow(pie::dbus::DBus &dbus, std::vector<pie::bench::Result> &results) {
+        constexpr size_t slow_calls = 100;
+        constexpr size_t total = 2000;
+        std::atomic<size_t> slow_completed{0};
+        std::atomic<size_t> slow_failed{0};
+        for (size_t i = 0; i < slow_calls; ++i) {
+            dbus.call_async(new_call("Slow"), [&](const pie::dbus::DBusResult &result, std::shared_ptr<DBusMessage>) {
+                if (result.code != pie::dbus::DBusResultCode::Success)
+                    ++slow_failed;
+
+                ++slow_completed;
+            }, slow_delay * 5);
+        }
+
+        std::vector<double> samples{};
+        samples.reserve(total);
+        size_t failed{0};
+        auto start = pie::bench::Clock::now();
+        for (size_t i = 0; i < total; ++i) {
+            auto call_start = pie::bench::Clock::now();
+            auto [result, reply] = dbus.send_with_reply(new_call(), 1000ms);
+            samples.push_back(pie::bench::to_us(pie::bench::Clock::now() - call_start));
+            if (result.code != pie::dbus::DBusResultCode::Success)
+                ++failed;
+        }
+
+        auto elapsed = pie::bench::Clock::now() - start;
+        // slow replies completed before round trips ended mean the measurement did not overlap them
+        auto pending_at_end = slow_calls - slow_completed.load();
+        while (slow_completed.load() < slow_calls && pie::bench::Clock::now() - start < slow_delay * 10)
+            std::this_thread::sleep_for(1ms);
+
+        pie::bench::Result result{"dbus_throughput/call_async_slow"};
+        add_rate(result, total, elapsed);
+        result.add("failed", static_cast<double>(failed));
+        result.add("slow_pending_at_end", static_cast<double>(pending_at_end));
+        result.add("slow_completed", static_cast<double>(slow_completed.load()));
+        result.add("slow_failed", static_cast<double>(slow_failed.load()));
+        pie::bench::add_latency(result, samples);
+        results.emplace_back(std::move(result));
+    }
+
+    void send_with_reply(pie::dbus::DBus &dbus, std::vector<pie::bench::Result> &results) {
+        constexpr size_t total = 5000;
+        std::vector<double> samples{};
+        samples.reserve(total);
+        size_t failed{0};
+        auto start = pie::bench::Clock::now();
+        for (size_t i = 0; i < total; ++i) {
+            auto call_start = pie::bench::Clock::now();
+            auto [result, reply] = dbus.send_with_reply(new_call(), 1000ms);
+            samples.push_back(pie::bench::to_us(pie::bench::Clock::now() - call_start));
+            if (result.code != pie::dbus::DBusResultCode::Success)
+                ++failed;
+        }
+
+        pie::bench::Result result{"dbus_throughput/send_with_reply"};
+        add_rate(result, total, pie::bench::Clock::now() - start);
+        result.add("failed", static_cast<double>(failed));
+        pie::bench::add_latency(result, samples);
+        results.emplace_back(std::move(result));
+    }
+
+    const bool registered = pie::bench::register_benchmark(
+        "dbus_throughput", [](std::vector<pie::bench::Result> &results) {
+            try {
+                pie::bench::DBusDaemon daemon{};
+                Peer peer{daemon.address()};
+                pie::dbus::DBusConfig config{};
+                config.bus_type = pie::dbus::DBusBusType::Address;
+                config.address = daemon.address();
+                pie::dbus::DBus dbus{std::make_shared<NullLogger>(), config};
+                if (dbus.state() != pie::dbus::DBusState::Running)
+                    throw std::runtime_error("DBus failed to connect to " + daemon.address());
+
+                send_signals(dbus, peer, results);
+                call_async(dbus, results);
+                call_async_slow(dbus, results);
+                send_with_reply(dbus, results);
+            } catch (const std::exception &e) {
+                std::cerr << "dbus_throughput skipped: " << e.what() << std::endl;
+            }
+        });
+}
@@ -0,0 +1,93 @@
+/**
+* @file bench_dispatch.cpp
+* @author Ilija Poznic
+* @date 2025
+*
+* Cost of dispatching one incoming method call with N registered objects:
+* linear chain of on_message subscribers (previous behaviour) vs DBusRouter.
+*/
+
+#include "bench.h"
+
+#include "pie/bluez/gatt/helper/characteristic.h"
+#include "pie/dbus/DBusRouter.h"
+#include "pie/dbus/helper/dbus.h"
+
+#include <sstream>
+
+namespace {
+    constexpr size_t iterations{200000};
+
+    std::string object_path(size_t index) {
+        std::stringstream ss;
+        ss << "/rs/pie/bench/service0/characteristic" << index;
+        return ss.str();
+    }
+
+    std::shared_ptr<DBusMessage> write_value_message(const std::string &path) {
+        return {
+            dbus_message_new_method_call(
+                "rs.pie.bench", path.c_str(), pie::bluez::gatt::characteristic::iface,
+                pie::bluez::gatt::characteristic::to_string(
+                    pie::bluez::gatt::characteristic::Methods::WriteValue).c_str()),
+            dbus_message_unref
+        };
+    }
+
+    template<typename Dispatch>
+    void run(const std::string &name, size_t objects, Dispatch dispatch, std::vector<pie::bench::Result> &results) {
+        // worst case for linear chain, target is the last registered object
+        auto message = write_value_message(object_path(objects - 1));
+        auto msg_info = pie::dbus::get_message_info(message);
+
+        auto start = pie::bench::Clock::now();
+        for (size_t i = 0; i < iterations; ++i)
+            pie::bench::do_not_optimize(dispatch(msg_info, message));
+        auto elapsed = pie::bench::Clock::now() - start;
+
+        pie::bench::Result result{name};
+        result.add("objects", static_cast<double>(objects));
+        result.add("ns_per_message", pie::bench::to_us(elapsed) * 1000.0 / iterations);
+        results.emplace_back(std::move(result));
+    }
+
+    void run_linear(size_t objects, std::vector<pie::bench::Result> &results) {
+        std::vector<std::string> paths{};
+        for (size_t i = 0; i < objects; ++i)
+            paths.emplace_back(object_path(i));
+
+        run("dispatch/linear", objects,
+            [&paths](const pie::dbus::DBusMessageInfo &msg_info, const std::shared_ptr<DBusMessage> &) {
+                for (const auto &path: paths)
+                    if (pie::bluez::gatt::characteristic::is_method(
+                        msg_info, path, pie::bluez::gatt::characteristic::Methods::WriteValue))
+                        return DBUS_HANDLER_RESULT_HANDLED;
+
+                return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+            }, results);
+    }
+
+    void run_router(size_t objects, std::vector<pie::bench::Result> &results) {
+        pie::dbus::DBusRouter router{};
+        auto member = pie::bluez::gatt::characteristic::to_string(
+            pie::bluez::gatt::characteristic::Methods::WriteValue);
+        for (size_t i = 0; i < objects; ++i)
+            router.add_method(object_path(i), pie::bluez::gatt::characteristic::iface, member,
+                              [](const pie::dbus::DBusMessageInfo &, std::shared_ptr<DBusMessage>) {
+                                  return DBUS_HANDLER_RESULT_HANDLED;
+                              });
+
+        run("dispatch/router", objects,
+            [&router](const pie::dbus::DBusMessageInfo &msg_info, const std::shared_ptr<DBusMessage> &message) {
+                return router.route(msg_info, message);
+            }, results);
+    }
+
+    const bool registered = pie::bench::register_benchmark(
+        "dispatch", [](std::vector<pie::bench::Result> &results) {
+            for (size_t objects: {1, 10, 100, 1000}) {
+                run_linear(objects, results);
+                run_router(objects, results);
+            }
+        });
+}
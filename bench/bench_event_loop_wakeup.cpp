@@ -0,0 +1,53 @@
+/**
+* @file bench_event_loop_wakeup.cpp
+* @author Ilija Poznic
+* @date 2025
+*
+* Handoff latency from caller thread to thread blocked in DBusEventLoop::run_once.
+*/
+
+#include "bench.h"
+
+#include "pie/dbus/helper/DBusEventLoop.h"
+
+#include <atomic>
+#include <thread>
+
+namespace {
+    const bool registered = pie::bench::register_benchmark(
+        "event_loop_wakeup", [](std::vector<pie::bench::Result> &results) {
+            constexpr size_t iterations = 20000;
+            pie::dbus::DBusEventLoop event_loop{};
+            std::atomic<bool> running{true};
+            std::atomic<pie::bench::Clock::rep> pushed_at{0};
+            std::atomic<size_t> handled{0};
+            std::vector<double> samples{};
+            samples.reserve(iterations);
+
+            std::thread loop_thread([&] {
+                while (running) {
+                    event_loop.run_once(-1);
+                    auto start = pie::bench::Clock::time_point(pie::bench::Clock::duration(pushed_at.load()));
+                    samples.push_back(pie::bench::to_us(pie::bench::Clock::now() - start));
+                    ++handled;
+                }
+            });
+
+            for (size_t i = 0; i < iterations; ++i) {
+                auto expected = handled.load() + 1;
+                pushed_at = pie::bench::Clock::now().time_since_epoch().count();
+                event_loop.wakeup();
+                while (handled.load() < expected)
+                    std::this_thread::yield();
+            }
+
+            running = false;
+            event_loop.wakeup();
+            loop_thread.join();
+            samples.resize(iterations);
+
+            pie::bench::Result result{"event_loop_wakeup/handoff"};
+            pie::bench::add_latency(result, samples);
+            results.emplace_back(std::move(result));
+        });
+}
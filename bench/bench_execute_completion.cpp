@@ -0,0 +1,74 @@
+/**
+* @file bench_execute_completion.cpp
+* @author Ilija Poznic
+* @date 2025
+*
+* Caller side latency of a command executed on a separate "DBus" thread:
+* sleep-polling of status() (previous DBus::send behaviour) vs wait_until().
+*/
+
+#include "bench.h"
+
+#include "pie/concurrent/ConcurrentQueue.h"
+#include "pie/dbus/helper/DBusMessageExecuteBase.h"
+
+#include <atomic>
+#include <thread>
+
+namespace {
+    class NoopDBusMessageExecute : public pie::dbus::DBusMessageExecuteBase {
+    public:
+        NoopDBusMessageExecute() : DBusMessageExecuteBase(nullptr) {
+        }
+
+        void exec(DBusConnection *) override {
+            status(Status::Running);
+            finish({}, nullptr);
+        }
+    };
+
+    using Command = std::shared_ptr<pie::dbus::DBusMessageExecuteBase>;
+
+    template<typename Wait>
+    void run(const std::string &name, size_t iterations, Wait wait, std::vector<pie::bench::Result> &results) {
+        pie::concurrent::ConcurrentQueue<Command> queue{};
+        std::atomic<bool> running{true};
+        std::thread consumer([&] {
+            while (running) {
+                if (auto cmd = queue.try_pop())
+                    (*cmd)->exec(nullptr);
+                else
+                    std::this_thread::yield();
+            }
+        });
+
+        std::vector<double> samples{};
+        samples.reserve(iterations);
+        for (size_t i = 0; i < iterations; ++i) {
+            auto cmd = std::make_shared<NoopDBusMessageExecute>();
+            auto start = pie::bench::Clock::now();
+            queue.push(cmd);
+            wait(cmd);
+            samples.push_back(pie::bench::to_us(pie::bench::Clock::now() - start));
+        }
+
+        running = false;
+        consumer.join();
+
+        pie::bench::Result result{name};
+        pie::bench::add_latency(result, samples);
+        results.emplace_back(std::move(result));
+    }
+
+    const bool registered = pie::bench::register_benchmark(
+        "execute_completion", [](std::vector<pie::bench::Result> &results) {
+            run("execute_completion/sleep_poll", 500, [](const Command &cmd) {
+                while (cmd->status() != pie::dbus::DBusMessageExecuteBase::Status::Finished)
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }, results);
+
+            run("execute_completion/wait_until", 20000, [](const Command &cmd) {
+                cmd->wait_until(pie::bench::Clock::now() + std::chrono::milliseconds(25));
+            }, results);
+        });
+}
@@ -0,0 +1,205 @@
+/**
+* @file bench_gatt.cpp
+* @author Ilija Poznic
+* @date 2025
+*
+* GATT object cost on synthetic messages, no bus needed (DBus instance is created only for its router):
+* Service::get_managed_objects reply with N characteristics, WriteValue dispatched
+* through DBusRouter to Characteristic::on_message and ReadValue replies built from cached value,
+* including ReadValue with malformed options (a{yq}) which must be answered with an error, not dropped.
+*/
+
+#include "bench.h"
+
+#include "pie/bluez/gatt/Characteristic.h"
+#include "pie/bluez/gatt/Service.h"
+#include "pie/dbus/helper/dbus.h"
+#include "pie/logging/ConsoleLogger.h"
+
+#include <chrono>
+
+namespace {
+    constexpr size_t iterations{20000};
+
+    class NullSubscriber : public pie::bluez::gatt::OnValueChanged {
+    public:
+        void on_value_changed(const std::string &, const pie::dbus::ByteView &value) override {
+            pie::bench::do_not_optimize(value.size());
+        }
+    };
+
+    struct Application {
+        std::shared_ptr<pie::Logger> logger;
+        std::shared_ptr<pie::dbus::DBus> dbus;
+        std::shared_ptr<NullSubscriber> subscriber;
+        std::shared_ptr<pie::bluez::gatt::Service> service;
+        std::vector<std::shared_ptr<pie::bluez::gatt::Characteristic> > characteristics{};
+    };
+
+    /**
+     * Service with characteristics, DBus is never connected
+     */
+    Application make_application(size_t characteristics) {
+        Application app{};
+        app.logger = std::make_shared<pie::logging::ConsoleLogger>();
+        app.logger->log_level(pie::LogLevel::None);
+        pie::dbus::DBusConfig config{};
+        config.bus_type = pie::dbus::DBusBusType::Address;
+        config.address = "unix:path=/nonexistent/pie_bench";
+        app.dbus = std::make_shared<pie::dbus::DBus>(app.logger, config);
+        app.subscriber = std::make_shared<NullSubscriber>();
+        app.service = std::make_shared<pie::bluez::gatt::Service>(
+            "6e400001-b5a3-f393-e0a9-e50e24dcca9e", "/rs/pie/bench", true, app.dbus, app.logger);
+        for (size_t i = 0; i < characteristics; ++i) {
+            auto chr = std::make_shared<pie::bluez::gatt::Characteristic>(
+                "6e400002-b5a3-f393-e0a9-e50e24dcca9e", app.service,
+                std::vector{
+                    pie::bluez::gatt::characteristic::Flag::Read,
+                    pie::bluez::gatt::characteristic::Flag::WriteWithoutResponse
+                },
+                app.subscriber, app.dbus, app.logger);
+            app.service->add_characteristic(chr);
+            app.characteristics.emplace_back(std::move(chr));
+        }
+
+        return app;
+    }
+
+    double ns_per_iteration(pie::bench::Clock::duration elapsed, size_t count) {
+        return std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(count);
+    }
+
+    void run_get_managed_objects(size_t characteristics, std::vector<pie::bench::Result> &results) {
+        auto app = make_application(characteristics);
+        auto start = pie::bench::Clock::now();
+        for (size_t i = 0; i < iterations; ++i) {
+            std::shared_ptr<DBusMessage> msg{
+                dbus_message_new_signal("/rs/pie/bench", "rs.pie.Bench", "Objects"), dbus_message_unref
+            };
+            DBusMessageIter iter{nullptr};
+            dbus_message_iter_init_append(msg.get(), &iter);
+            DBusMessageIter dict_iter{nullptr};
+            dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY, "{oa{sa{sv}}}", &dict_iter);
+            app.service->get_managed_objects(&dict_iter);
+            dbus_message_iter_close_container(&iter, &dict_iter);
+            pie::bench::do_not_optimize(msg);
+        }
+
+        pie::bench::Result result{"gatt/get_managed_objects"};
+        result.add("characteristics", static_cast<double>(characteristics));
+        result.add("ns_per_call", ns_per_iteration(pie::bench::Clock::now() - start, iterations));
+        results.emplace_back(std::move(result));
+    }
+
+    std::shared_ptr<DBusMessage> write_value_message(const std::string &path, size_t size) {
+        std::shared_ptr<DBusMessage> msg{
+            dbus_message_new_method_call(
+                "rs.pie.bench", path.c_str(), pie::bluez::gatt::characteristic::iface,
+                pie::bluez::gatt::characteristic::to_string(
+                    pie::bluez::gatt::characteristic::Methods::WriteValue).c_str()),
+            dbus_message_unref
+        };
+
+        std::vector<uint8_t> value(size, 0x5a);
+        auto p_value = value.data();
+        DBusMessageIter iter{nullptr};
+        dbus_message_iter_init_append(msg.get(), &iter);
+        DBusMessageIter arr_iter{nullptr};
+        dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY, DBUS_TYPE_BYTE_AS_STRING, &arr_iter);
+        dbus_message_iter_append_fixed_array(&arr_iter, DBUS_TYPE_BYTE, &p_value, static_cast<int>(size));
+        dbus_message_iter_close_container(&iter, &arr_iter);
+        dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY, "{sv}", &arr_iter);
+        dbus_message_iter_close_container(&iter, &arr_iter);
+        dbus_message_set_serial(msg.get(), 1);
+        // replies are not expected, nothing would be sent anyway as DBus is not connected
+        dbus_message_set_no_reply(msg.get(), true);
+        return msg;
+    }
+
+    /**
+     * Same steps as DBus thread: get_message_info, route, Characteristic WriteValue handler
+     */
+    void run_write_value(size_t size, std::vector<pie::bench::Result> &results) {
+        auto app = make_application(1);
+        auto msg = write_value_message(app.characteristics.front()->path(), size);
+        auto start = pie::bench::Clock::now();
+        for (size_t i = 0; i < iterations; ++i) {
+            auto msg_info = pie::dbus::get_message_info(msg.get());
+            pie::bench::do_not_optimize(app.dbus->router().route(msg_info, msg));
+        }
+
+        pie::bench::Result result{"gatt/write_value_dispatch"};
+        result.add("bytes", static_cast<double>(size));
+        result.add("ns_per_message", ns_per_iteration(pie::bench::Clock::now() - start, iterations));
+        results.emplace_back(std::move(result));
+    }
+
+    /**
+     * @param malformed - a{yq} options instead of a{sv}
+     */
+    std::shared_ptr<DBusMessage> read_value_message(const std::string &path, bool malformed = false) {
+        std::shared_ptr<DBusMessage> msg{
+            dbus_message_new_method_call(
+                "rs.pie.bench", path.c_str(), pie::bluez::gatt::characteristic::iface,
+                pie::bluez::gatt::characteristic::to_string(
+                    pie::bluez::gatt::characteristic::Methods::ReadValue).c_str()),
+            dbus_message_unref
+        };
+
+        DBusMessageIter iter{nullptr};
+        dbus_message_iter_init_append(msg.get(), &iter);
+        DBusMessageIter arr_iter{nullptr};
+        dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY, malformed ? "{yq}" : "{sv}", &arr_iter);
+        if (malformed) {
+            DBusMessageIter entry_iter{nullptr};
+            dbus_message_iter_open_container(&arr_iter, DBUS_TYPE_DICT_ENTRY, nullptr, &entry_iter);
+            uint8_t key{1};
+            uint16_t value{2};
+            dbus_message_iter_append_basic(&entry_iter, DBUS_TYPE_BYTE, &key);
+            dbus_message_iter_append_basic(&entry_iter, DBUS_TYPE_UINT16, &value);
+            dbus_message_iter_close_container(&arr_iter, &entry_iter);
+        }
+
+        dbus_message_iter_close_container(&iter, &arr_iter);
+        dbus_message_set_serial(msg.get(), 1);
+        return msg;
+    }
+
+    /**
+     * Route ReadValue and build its reply, sending fails fast as bench is not on DBus thread
+     */
+    void run_read_value(size_t size, bool malformed, std::vector<pie::bench::Result> &results) {
+        auto app = make_application(1);
+        auto &chr = app.characteristics.front();
+        std::vector<uint8_t> value(size, 0x5a);
+        chr->value(value.data(), value.size());
+        auto msg = read_value_message(chr->path(), malformed);
+        size_t handled{0};
+        auto start = pie::bench::Clock::now();
+        for (size_t i = 0; i < iterations; ++i) {
+            auto msg_info = pie::dbus::get_message_info(msg.get());
+            if (app.dbus->router().route(msg_info, msg) == DBUS_HANDLER_RESULT_HANDLED)
+                ++handled;
+        }
+
+        auto ns = ns_per_iteration(pie::bench::Clock::now() - start, iterations);
+        pie::bench::Result result{malformed ? "gatt/read_value_invalid_options" : "gatt/read_value"};
+        result.add("bytes", static_cast<double>(size));
+        // malformed options are answered with InvalidArguments, unhandled calls would wait for client timeout
+        result.add("unhandled", static_cast<double>(iterations - handled));
+        result.add("ns_per_message", ns);
+        result.add("replies_per_s", 1e9 / ns);
+        results.emplace_back(std::move(result));
+    }
+
+    const bool registered = pie::bench::register_benchmark(
+        "gatt", [](std::vector<pie::bench::Result> &results) {
+            for (size_t characteristics: {1, 10, 100})
+                run_get_managed_objects(characteristics, results);
+            for (size_t size: {20, 512})
+                run_write_value(size, results);
+            for (size_t size: {20, 512})
+                run_read_value(size, false, results);
+            run_read_value(20, true, results);
+        });
+}
@@ -0,0 +1,64 @@
+/**
+* @file bench_logger_backend.cpp
+* @author Ilija Poznic
+* @date 2025
+*
+* Caller side latency of Logger::log: synchronous ConsoleLogger (std::cout, flush per line)
+* vs AsyncLogger. Output goes to /dev/null.
+*/
+
+#include "bench.h"
+
+#include "pie/logging/AsyncLogger.h"
+#include "pie/logging/ConsoleLogger.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+namespace {
+    constexpr size_t iterations{50000};
+    inline const char *log_file{"/tmp/pie_bench_logger_backend.log"};
+    inline const std::string message{
+        "DBus0|DBus::send message: {type: MethodCall, destination: org.bluez, path: /org/bluez/hci0}"
+    };
+
+    void run(const std::string &name, pie::Logger &logger, std::vector<pie::bench::Result> &results) {
+        std::vector<double> samples{};
+        samples.reserve(iterations);
+        for (size_t i = 0; i < iterations; ++i) {
+            auto start = pie::bench::Clock::now();
+            logger.log(pie::LogLevel::Information, message);
+            samples.push_back(pie::bench::to_us(pie::bench::Clock::now() - start));
+        }
+
+        pie::bench::Result result{name};
+        pie::bench::add_latency(result, samples);
+        results.emplace_back(std::move(result));
+    }
+
+    void run_async(const std::string &name, pie::logging::AsyncLoggerPolicy policy,
+                   std::vector<pie::bench::Result> &results) {
+        pie::logging::AsyncLogger logger{{.capacity = 4096, .policy = policy, .file = log_file}};
+        run(name, logger, results);
+        logger.flush();
+        results.back().add("written", static_cast<double>(logger.written()));
+        results.back().add("dropped", static_cast<double>(logger.dropped()));
+    }
+
+    const bool registered = pie::bench::register_benchmark(
+        "logger_backend", [](std::vector<pie::bench::Result> &results) {
+            {
+                // benchmark results are printed to stdout, redirect console logger
+                std::ofstream file_stream{log_file, std::ios::app};
+                auto cout_buf = std::cout.rdbuf(file_stream.rdbuf());
+                pie::logging::ConsoleLogger logger{};
+                run("logger_backend/console", logger, results);
+                std::cout.rdbuf(cout_buf);
+            }
+
+            run_async("logger_backend/async_drop", pie::logging::AsyncLoggerPolicy::Drop, results);
+            run_async("logger_backend/async_block", pie::logging::AsyncLoggerPolicy::Block, results);
+            std::remove(log_file);
+        });
+}
@@ -0,0 +1,127 @@
+/**
+* @file bench_logging.cpp
+* @author Ilija Poznic
+* @date 2025
+*
+* Per message cost of trace logging a DBus message when trace is disabled:
+* eager formatting (previous log_msg) vs pie::logger::log_lazy.
+*/
+
+#include "bench.h"
+
+#include "pie/dbus/helper/dbus.h"
+#include "pie/logging/BinaryLogger.h"
+#include "pie/logging/console_helpers.h"
+#include "pie/logging/log.h"
+
+#include <cstdio>
+#include <sstream>
+
+namespace {
+    constexpr size_t iterations{200000};
+    inline const pie::logging::LogTag &TAG = pie::logging::register_tag("bench");
+    inline const char *binary_log_file{"/tmp/pie_bench_logging.bin"};
+
+    class NullLogger : public pie::Logger {
+    public:
+        void log(pie::LogLevel level, std::string message) override {
+            if (is_enabled(level))
+                pie::bench::do_not_optimize(message);
+        }
+    };
+
+    template<typename Log>
+    void run(const std::string &name, std::shared_ptr<pie::Logger> logger, Log log,
+             std::vector<pie::bench::Result> &results) {
+        std::shared_ptr<DBusMessage> msg{
+            dbus_message_new_method_call("rs.pie.bench", "/rs/pie/bench", "rs.pie.Bench", "Ping"),
+            dbus_message_unref
+        };
+
+        auto start = pie::bench::Clock::now();
+        for (size_t i = 0; i < iterations; ++i) {
+            log(logger, msg);
+            pie::bench::do_not_optimize(msg);
+        }
+        auto elapsed = pie::bench::Clock::now() - start;
+
+        pie::bench::Result result{name};
+        result.add("ns_per_message", pie::bench::to_us(elapsed) * 1000.0 / iterations);
+        results.emplace_back(std::move(result));
+    }
+
+    template<typename Log>
+    void run(const std::string &name, pie::LogLevel logger_level, Log log,
+             std::vector<pie::bench::Result> &results) {
+        std::shared_ptr<pie::Logger> logger = std::make_shared<NullLogger>();
+        logger->log_level(logger_level);
+        run(name, logger, log, results);
+    }
+
+    void log_message_format(const std::shared_ptr<pie::Logger> &logger, const std::shared_ptr<DBusMessage> &msg) {
+        static const auto &format = pie::logging::register_format(
+            TAG, "DBus::send message: {type: {}, destination: {}, path: {}, iface: {}, member: {}, serial: {}}");
+        auto msg_info = pie::dbus::get_message_info(msg);
+        pie::logger::log_format<pie::LogLevel::Information>(
+            logger, format, pie::dbus::to_string(msg_info.type), msg_info.destination, msg_info.path,
+            msg_info.iface, msg_info.member, msg_info.serial);
+    }
+
+    const bool registered = pie::bench::register_benchmark(
+        "logging", [](std::vector<pie::bench::Result> &results) {
+            run("logging/none", pie::LogLevel::Information, [](const std::shared_ptr<pie::Logger> &, const std::shared_ptr<DBusMessage> &) {
+            }, results);
+
+            run("logging/eager_disabled", pie::LogLevel::Information,
+                [](const std::shared_ptr<pie::Logger> &logger, const std::shared_ptr<DBusMessage> &msg) {
+                    std::stringstream ss{};
+                    ss << TAG.name() << "|DBus::send message: " << pie::dbus::get_message_info(msg);
+                    logger->log(pie::LogLevel::Trace, ss.str());
+                }, results);
+
+            run("logging/lazy_compiled_out", pie::LogLevel::Information,
+                [](const std::shared_ptr<pie::Logger> &logger, const std::shared_ptr<DBusMessage> &msg) {
+                    pie::logger::log_lazy<pie::LogLevel::Trace>(logger, TAG, [&msg](std::ostream &os) {
+                        os << "DBus::send message: " << pie::dbus::get_message_info(msg);
+                    });
+                }, results);
+
+            run("logging/lazy_runtime_disabled", pie::LogLevel::Warning,
+                [](const std::shared_ptr<pie::Logger> &logger, const std::shared_ptr<DBusMessage> &msg) {
+                    pie::logger::log_lazy<pie::LogLevel::Information>(logger, TAG, [&msg](std::ostream &os) {
+                        os << "DBus::send message: " << pie::dbus::get_message_info(msg);
+                    });
+                }, results);
+
+            pie::logging::set_tag_level(TAG.name(), pie::LogLevel::Warning);
+            run("logging/lazy_tag_disabled", pie::LogLevel::Information,
+                [](const std::shared_ptr<pie::Logger> &logger, const std::shared_ptr<DBusMessage> &msg) {
+                    pie::logger::log_lazy<pie::LogLevel::Information>(logger, TAG, [&msg](std::ostream &os) {
+                        os << "DBus::send message: " << pie::dbus::get_message_info(msg);
+                    });
+                }, results);
+            pie::logging::set_tag_level(TAG.name(), pie::LogLevel::Trace);
+
+            run("logging/lazy_enabled", pie::LogLevel::Information,
+                [](const std::shared_ptr<pie::Logger> &logger, const std::shared_ptr<DBusMessage> &msg) {
+                    pie::logger::log_lazy<pie::LogLevel::Information>(logger, TAG, [&msg](std::ostream &os) {
+                        os << "DBus::send message: " << pie::dbus::get_message_info(msg);
+                    });
+                }, results);
+
+            run("logging/format_enabled", pie::LogLevel::Information,
+                [](const std::shared_ptr<pie::Logger> &logger, const std::shared_ptr<DBusMessage> &msg) {
+                    log_message_format(logger, msg);
+                }, results);
+
+            {
+                pie::logging::BinaryLoggerConfig config{};
+                config.file = binary_log_file;
+                run("logging/binary_enabled", std::make_shared<pie::logging::BinaryLogger>(config),
+                    [](const std::shared_ptr<pie::Logger> &logger, const std::shared_ptr<DBusMessage> &msg) {
+                        log_message_format(logger, msg);
+                    }, results);
+                std::remove(binary_log_file);
+            }
+        });
+}
@@ -0,0 +1,165 @@
+/**
+* @file bench_marshalling.cpp
+* @author Ilija Poznic
+* @date 2025
+*
+* Cost of message helpers on synthetic messages, no bus needed:
+* message_append_dict_entry overloads (16 entries per message, empty message cost subtracted),
+* message_get_bytes / message_get_byte_view of WriteValue payload and get_message_info.
+*/
+
+#include "bench.h"
+
+#include "pie/bluez/gatt/helper/characteristic.h"
+#include "pie/dbus/helper/dbus.h"
+
+#include <chrono>
+
+namespace {
+    constexpr size_t iterations{100000};
+    constexpr size_t entries_per_message{16};
+
+    double ns_per_iteration(pie::bench::Clock::duration elapsed, size_t count) {
+        return std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(count);
+    }
+
+    std::shared_ptr<DBusMessage> new_signal() {
+        return {dbus_message_new_signal("/rs/pie/bench", "rs.pie.Bench", "Changed"), dbus_message_unref};
+    }
+
+    /**
+     * Time to create message with a{sv} of entries_per_message entries appended by append
+     */
+    template<typename Append>
+    double message_ns(Append append, size_t entries) {
+        auto start = pie::bench::Clock::now();
+        for (size_t i = 0; i < iterations; ++i) {
+            auto msg = new_signal();
+            DBusMessageIter iter{nullptr};
+            dbus_message_iter_init_append(msg.get(), &iter);
+            DBusMessageIter arr_iter{nullptr};
+            dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY, "{sv}", &arr_iter);
+            for (size_t entry = 0; entry < entries; ++entry)
+                append(&arr_iter);
+            dbus_message_iter_close_container(&iter, &arr_iter);
+            pie::bench::do_not_optimize(msg);
+        }
+
+        return ns_per_iteration(pie::bench::Clock::now() - start, iterations);
+    }
+
+    template<typename Append>
+    void run_append(const std::string &name, double empty_ns, Append append,
+                    std::vector<pie::bench::Result> &results) {
+        pie::bench::Result result{name};
+        result.add("ns_per_entry", (message_ns(append, entries_per_message) - empty_ns) / entries_per_message);
+        results.emplace_back(std::move(result));
+    }
+
+    void run_append_all(std::vector<pie::bench::Result> &results) {
+        auto empty_ns = message_ns([](DBusMessageIter *) {
+        }, 0);
+        pie::bench::Result empty{"marshal/empty_message"};
+        empty.add("ns_per_message", empty_ns);
+        results.emplace_back(std::move(empty));
+
+        const std::string key{"UUID"};
+        const std::string uuid{"6e400002-b5a3-f393-e0a9-e50e24dcca9e"};
+        const std::vector<std::string> flags{"read", "write-without-response", "notify"};
+        const std::vector<uint8_t> value(20, 0x5a);
+        run_append("marshal/append_string", empty_ns, [&](DBusMessageIter *iter) {
+            pie::dbus::message_append_dict_entry(iter, key, uuid);
+        }, results);
+        run_append("marshal/append_bool", empty_ns, [&](DBusMessageIter *iter) {
+            pie::dbus::message_append_dict_entry(iter, key, true);
+        }, results);
+        run_append("marshal/append_strings_3", empty_ns, [&](DBusMessageIter *iter) {
+            pie::dbus::message_append_dict_entry(iter, key, flags);
+        }, results);
+        run_append("marshal/append_bytes_20", empty_ns, [&](DBusMessageIter *iter) {
+            pie::dbus::message_append_dict_entry(iter, key, value);
+        }, results);
+        run_append("marshal/append_object", empty_ns, [&](DBusMessageIter *iter) {
+            pie::dbus::message_append_dict_entry_object(iter, key, "/rs/pie/bench/service0");
+        }, results);
+    }
+
+    /**
+     * WriteValue(ay value, a{sv} options) as sent by bluetoothd
+     */
+    std::shared_ptr<DBusMessage> write_value_message(size_t size) {
+        std::shared_ptr<DBusMessage> msg{
+            dbus_message_new_method_call(
+                "rs.pie.bench", "/rs/pie/bench/service0/characteristic0", pie::bluez::gatt::characteristic::iface,
+                pie::bluez::gatt::characteristic::to_string(
+                    pie::bluez::gatt::characteristic::Methods::WriteValue).c_str()),
+            dbus_message_unref
+        };
+
+        std::vector<uint8_t> value(size, 0x5a);
+        auto p_value = value.data();
+        DBusMessageIter iter{nullptr};
+        dbus_message_iter_init_append(msg.get(), &iter);
+        DBusMessageIter arr_iter{nullptr};
+        dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY, DBUS_TYPE_BYTE_AS_STRING, &arr_iter);
+        dbus_message_iter_append_fixed_array(&arr_iter, DBUS_TYPE_BYTE, &p_value, static_cast<int>(size));
+        dbus_message_iter_close_container(&iter, &arr_iter);
+        dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY, "{sv}", &arr_iter);
+        pie::dbus::message_append_dict_entry_object(&arr_iter, "device", "/org/bluez/hci0/dev_00_11_22_33_44_55");
+        dbus_message_iter_close_container(&iter, &arr_iter);
+        // serial is set by connection, fixed one makes message look received
+        dbus_message_set_serial(msg.get(), 1);
+        return msg;
+    }
+
+    void run_get_bytes(size_t size, std::vector<pie::bench::Result> &results) {
+        auto msg = write_value_message(size);
+        auto start = pie::bench::Clock::now();
+        for (size_t i = 0; i < iterations; ++i) {
+            DBusMessageIter iter{nullptr};
+            dbus_message_iter_init(msg.get(), &iter);
+            pie::bench::do_not_optimize(pie::dbus::message_get_bytes(&iter));
+        }
+
+        pie::bench::Result result{"unmarshal/get_bytes"};
+        result.add("bytes", static_cast<double>(size));
+        result.add("ns_per_call", ns_per_iteration(pie::bench::Clock::now() - start, iterations));
+        results.emplace_back(std::move(result));
+    }
+
+    void run_get_byte_view(size_t size, std::vector<pie::bench::Result> &results) {
+        auto msg = write_value_message(size);
+        auto start = pie::bench::Clock::now();
+        for (size_t i = 0; i < iterations; ++i) {
+            DBusMessageIter iter{nullptr};
+            dbus_message_iter_init(msg.get(), &iter);
+            pie::bench::do_not_optimize(pie::dbus::message_get_byte_view(msg.get(), &iter));
+        }
+
+        pie::bench::Result result{"unmarshal/get_byte_view"};
+        result.add("bytes", static_cast<double>(size));
+        result.add("ns_per_call", ns_per_iteration(pie::bench::Clock::now() - start, iterations));
+        results.emplace_back(std::move(result));
+    }
+
+    void run_get_message_info(std::vector<pie::bench::Result> &results) {
+        auto msg = write_value_message(20);
+        auto start = pie::bench::Clock::now();
+        for (size_t i = 0; i < iterations; ++i)
+            pie::bench::do_not_optimize(pie::dbus::get_message_info(msg.get()));
+
+        pie::bench::Result result{"unmarshal/get_message_info"};
+        result.add("ns_per_call", ns_per_iteration(pie::bench::Clock::now() - start, iterations));
+        results.emplace_back(std::move(result));
+    }
+
+    const bool registered = pie::bench::register_benchmark(
+        "marshalling", [](std::vector<pie::bench::Result> &results) {
+            run_append_all(results);
+            for (size_t size: {20, 512}) {
+                run_get_bytes(size, results);
+                run_get_byte_view(size, results);
+            }
+            run_get_message_info(results);
+        });
+}
@@ -0,0 +1,69 @@
+/**
+* @file bench_metrics.cpp
+* @author Ilija Poznic
+* @date 2025
+*
+* Cost of metrics updates on hot path: sharded counter and histogram vs single shared atomic,
+* from one and from several threads.
+*/
+
+#include "bench.h"
+
+#include "pie/metrics/Registry.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace {
+    constexpr size_t iterations{2000000};
+
+    template<typename Update>
+    void run(const std::string &name, size_t threads, Update update, std::vector<pie::bench::Result> &results) {
+        std::vector<std::thread> workers{};
+        auto start = pie::bench::Clock::now();
+        for (size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([&update] {
+                for (size_t i = 0; i < iterations; ++i)
+                    update(i);
+            });
+        }
+
+        for (auto &worker: workers)
+            worker.join();
+
+        auto elapsed = pie::bench::Clock::now() - start;
+        pie::bench::Result result{name};
+        result.add("threads", static_cast<double>(threads));
+        result.add("ns_per_update",
+                   std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(iterations * threads));
+        results.emplace_back(std::move(result));
+    }
+
+    const bool registered = pie::bench::register_benchmark(
+        "metrics", [](std::vector<pie::bench::Result> &results) {
+            auto &counter = pie::metrics::counter("bench_counter_total");
+            auto &histogram = pie::metrics::histogram("bench_histogram_ns");
+            std::atomic<uint64_t> shared{0};
+
+            for (size_t threads: {1, 4}) {
+                auto suffix = "/" + std::to_string(threads);
+                run("metrics/shared_atomic" + suffix, threads, [&shared](size_t) {
+                    shared.fetch_add(1, std::memory_order_relaxed);
+                }, results);
+
+                run("metrics/counter" + suffix, threads, [&counter](size_t) {
+                    counter.add();
+                }, results);
+
+                run("metrics/histogram" + suffix, threads, [&histogram](size_t i) {
+                    histogram.record(static_cast<uint64_t>(i & 0xffff));
+                }, results);
+
+                run("metrics/histogram_with_clock" + suffix, threads, [&histogram](size_t) {
+                    auto start = std::chrono::steady_clock::now();
+                    histogram.record(std::chrono::steady_clock::now() - start);
+                }, results);
+            }
+        });
+}
@@ -0,0 +1,115 @@
+/**
+* @file bench_notify.cpp
+* @author Ilija Poznic
+* @date 2025
+*
+* Notification throughput over seqpacket socket pair standing in for AcquireNotify socket of bluetoothd:
+* SeqPacketWriter (ring + sendmmsg) against one send per notification. Peer end is drained with recvmmsg
+* on the same thread after every round, so both variants pay the same receive cost.
+*/
+
+#include "bench.h"
+
+#include "pie/io/SeqPacketWriter.h"
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <array>
+#include <chrono>
+#include <stdexcept>
+
+namespace {
+    constexpr size_t packets{200000};
+    constexpr size_t round_size{64};
+
+    struct SocketPair {
+        SocketPair() {
+            if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, fds) != 0)
+                throw std::runtime_error("socketpair failed");
+        }
+
+        ~SocketPair() {
+            for (auto fd: fds) {
+                if (fd >= 0)
+                    close(fd);
+            }
+        }
+
+        int fds[2]{-1, -1};
+    };
+
+    /**
+     * Read all pending packets of peer end
+     */
+    size_t drain(int fd) {
+        std::array<std::array<uint8_t, 512>, round_size> buffers{};
+        std::array<iovec, round_size> iovs{};
+        std::array<mmsghdr, round_size> msgs{};
+        for (size_t i = 0; i < round_size; ++i) {
+            iovs[i] = {buffers[i].data(), buffers[i].size()};
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        size_t total{0};
+        int cnt{0};
+        while ((cnt = recvmmsg(fd, msgs.data(), round_size, MSG_DONTWAIT, nullptr)) > 0)
+            total += static_cast<size_t>(cnt);
+
+        return total;
+    }
+
+    void add_result(const std::string &name, size_t size, pie::bench::Clock::duration elapsed, size_t received,
+                    std::vector<pie::bench::Result> &results) {
+        auto seconds = std::chrono::duration<double>(elapsed).count();
+        pie::bench::Result result{name};
+        result.add("bytes", static_cast<double>(size));
+        result.add("received", static_cast<double>(received));
+        result.add("ns_per_packet", seconds * 1e9 / static_cast<double>(packets));
+        result.add("packets_per_s", static_cast<double>(received) / seconds);
+        results.emplace_back(std::move(result));
+    }
+
+    void run_writer(size_t size, std::vector<pie::bench::Result> &results) {
+        SocketPair pair{};
+        pie::io::SeqPacketWriter writer{pair.fds[0], size, 256};
+        pair.fds[0] = -1;
+        std::vector<uint8_t> value(size, 0x5a);
+        size_t received{0};
+        auto start = pie::bench::Clock::now();
+        for (size_t sent = 0; sent < packets; sent += round_size) {
+            for (size_t i = 0; i < round_size; ++i)
+                writer.push(value.data(), value.size());
+
+            writer.flush(round_size);
+            received += drain(pair.fds[1]);
+        }
+
+        add_result("notify/writer_sendmmsg", size, pie::bench::Clock::now() - start, received, results);
+    }
+
+    void run_send(size_t size, std::vector<pie::bench::Result> &results) {
+        SocketPair pair{};
+        std::vector<uint8_t> value(size, 0x5a);
+        size_t received{0};
+        auto start = pie::bench::Clock::now();
+        for (size_t sent = 0; sent < packets; sent += round_size) {
+            for (size_t i = 0; i < round_size; ++i)
+                send(pair.fds[0], value.data(), value.size(), MSG_DONTWAIT | MSG_NOSIGNAL);
+
+            received += drain(pair.fds[1]);
+        }
+
+        add_result("notify/send_per_packet", size, pie::bench::Clock::now() - start, received, results);
+    }
+
+    const bool registered = pie::bench::register_benchmark(
+        "notify", [](std::vector<pie::bench::Result> &results) {
+            // 20 bytes - default ATT_MTU, 244 bytes - LE data length extension
+            for (size_t size: {20, 244}) {
+                run_send(size, results);
+                run_writer(size, results);
+            }
+        });
+}
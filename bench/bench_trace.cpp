@@ -0,0 +1,40 @@
+/**
+* @file bench_trace.cpp
+* @author Ilija Poznic
+* @date 2025
+*
+* Cost of PIE_TRACE_SCOPE: compiled out (default build), compiled in but disabled at runtime and recording.
+* Build with -DPIE_ENABLE_TRACE=ON to measure the last two.
+*/
+
+#include "bench.h"
+
+#include "pie/trace/Trace.h"
+
+#include <chrono>
+
+namespace {
+    constexpr size_t iterations{1000000};
+
+    void run(const std::string &name, std::vector<pie::bench::Result> &results) {
+        auto start = pie::bench::Clock::now();
+        for (size_t i = 0; i < iterations; ++i) {
+            PIE_TRACE_SCOPE("bench::span");
+            pie::bench::do_not_optimize(i);
+        }
+
+        auto elapsed = pie::bench::Clock::now() - start;
+        pie::bench::Result result{name};
+        result.add("compiled", pie::trace::compiled ? 1.0 : 0.0);
+        result.add("ns_per_span", std::chrono::duration<double, std::nano>(elapsed).count() / iterations);
+        results.emplace_back(std::move(result));
+    }
+
+    const bool registered = pie::bench::register_benchmark(
+        "trace", [](std::vector<pie::bench::Result> &results) {
+            pie::trace::enabled(false);
+            run("trace/runtime_disabled", results);
+            pie::trace::enabled(true);
+            run("trace/enabled", results);
+        });
+}
@@ -0,0 +1,54 @@
+/**
+* @file dbus_daemon.cpp
+* @author Ilija Poznic
+* @date 2025
+*/
+
+#include "dbus_daemon.h"
+
+#include <csignal>
+#include <stdexcept>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace pie::bench {
+    DBusDaemon::DBusDaemon(const std::string &executable) {
+        int fds[2];
+        if (pipe(fds) != 0)
+            throw std::runtime_error("pipe failed");
+
+        pid = fork();
+        if (pid < 0)
+            throw std::runtime_error("fork failed");
+
+        if (pid == 0) {
+            close(fds[0]);
+            auto print_address = "--print-address=" + std::to_string(fds[1]);
+            execl(executable.c_str(), executable.c_str(), "--session", "--nofork", print_address.c_str(), nullptr);
+            _exit(127);
+        }
+
+        close(fds[1]);
+        char ch{0};
+        while (read(fds[0], &ch, 1) == 1 && ch != '\n')
+            address_.push_back(ch);
+
+        close(fds[0]);
+        if (address_.empty()) {
+            kill(pid, SIGTERM);
+            waitpid(pid, nullptr, 0);
+            throw std::runtime_error("failed to start " + executable);
+        }
+    }
+
+    DBusDaemon::~DBusDaemon() {
+        if (pid > 0) {
+            kill(pid, SIGTERM);
+            waitpid(pid, nullptr, 0);
+        }
+    }
+
+    const std::string &DBusDaemon::address() const {
+        return address_;
+    }
+}
@@ -0,0 +1,36 @@
+/**
+* @file dbus_daemon.h
+* @author Ilija Poznic
+* @date 2025
+*/
+
+#pragma once
+
+#include <string>
+#include <sys/types.h>
+
+namespace pie::bench {
+    /**
+     * Private dbus-daemon child process, running until object is destroyed
+     */
+    class DBusDaemon {
+    public:
+        /**
+         * @param executable - path to dbus-daemon
+         * @throw std::runtime_error if daemon can not be started
+         */
+        explicit DBusDaemon(const std::string &executable = PIE_DBUS_DAEMON);
+
+        ~DBusDaemon();
+
+        DBusDaemon(const DBusDaemon &) = delete;
+
+        DBusDaemon &operator=(const DBusDaemon &) = delete;
+
+        [[nodiscard]] const std::string &address() const;
+
+    private:
+        pid_t pid{-1};
+        std::string address_{};
+    };
+}
@@ -0,0 +1,58 @@
+/**
+* @file main.cpp
+* @author Ilija Poznic
+* @date 2025
+*/
+
+#include "bench.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <map>
+
+namespace {
+    std::map<std::string, pie::bench::Benchmark> &benchmarks() {
+        static std::map<std::string, pie::bench::Benchmark> registry{};
+        return registry;
+    }
+
+    void print_json(const std::vector<pie::bench::Result> &results) {
+        std::cout << "{\"benchmarks\": [";
+        for (size_t i = 0; i < results.size(); ++i) {
+            const auto &result = results[i];
+            std::cout << (i == 0 ? "" : ",") << "\n  {\"name\": \"" << result.name << "\"";
+            for (const auto &[key, value]: result.values)
+                std::cout << ", \"" << key << "\": " << value;
+
+            std::cout << "}";
+        }
+
+        std::cout << "\n]}" << std::endl;
+    }
+}
+
+namespace pie::bench {
+    bool register_benchmark(const std::string &name, Benchmark benchmark) {
+        benchmarks().emplace(name, std::move(benchmark));
+        return true;
+    }
+}
+
+/**
+ * Usage: pie_bench [filter]
+ * Runs all registered benchmarks whose name contains filter and prints results as JSON
+ */
+int main(int argc, char **argv) {
+    std::string filter = argc > 1 ? argv[1] : "";
+    std::vector<pie::bench::Result> results{};
+    for (const auto &[name, benchmark]: benchmarks()) {
+        if (!filter.empty() && name.find(filter) == std::string::npos)
+            continue;
+
+        std::cerr << "running " << name << std::endl;
+        benchmark(results);
+    }
+
+    print_json(results);
+    return EXIT_SUCCESS;
+}
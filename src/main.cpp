@@ -5,21 +5,82 @@
 */
 
 #include "pie/dbus/DBus.h"
+#include "pie/Diagnostics.h"
 #include "pie/GattSampleServer.h"
+#include "pie/Stats.h"
 #include "pie/bluez/LEAdvertisement.h"
 #include "pie/bluez/LEAdvertisingManager.h"
-#include <pie/logging/ConsoleLogger.h>
+#include <pie/logging/AsyncLogger.h>
+#include <pie/logging/BinaryLogger.h>
+#include <pie/metrics/PrometheusExporter.h>
 
 
 #include <cstdlib>
 #include <exception>
 #include <iostream>
+#include <memory>
+#include <string>
 
+namespace {
+    /**
+     * @param bus - "system", "session" or DBus address (e.g. unix:path=/tmp/dbus-test)
+     */
+    pie::dbus::DBusConfig to_dbus_config(const std::string &bus) {
+        pie::dbus::DBusConfig config{};
+        if (bus == "session") {
+            config.bus_type = pie::dbus::DBusBusType::Session;
+        } else if (bus != "system") {
+            config.bus_type = pie::dbus::DBusBusType::Address;
+            config.address = bus;
+        }
+
+        return config;
+    }
+
+    /**
+     * @param binary_log_file - if not empty or "-" records are stored in binary log, see pie_log_decode
+     */
+    std::shared_ptr<pie::Logger> make_logger(const std::string &binary_log_file) {
+        if (binary_log_file.empty() || binary_log_file == "-")
+            return std::make_shared<pie::logging::AsyncLogger>();
+
+        pie::logging::BinaryLoggerConfig config{};
+        config.file = binary_log_file;
+        return std::make_shared<pie::logging::BinaryLogger>(config);
+    }
+
+    /**
+     * @param endpoint - "unix:<path>", "tcp:<port>" (127.0.0.1) or empty for no exporter
+     */
+    std::unique_ptr<pie::metrics::PrometheusExporter> make_exporter(const std::string &endpoint,
+                                                                    const std::shared_ptr<pie::Logger> &logger) {
+        if (endpoint.empty())
+            return nullptr;
+
+        pie::metrics::PrometheusExporterConfig config{};
+        if (endpoint.rfind("unix:", 0) == 0)
+            config.unix_path = endpoint.substr(5);
+        else if (endpoint.rfind("tcp:", 0) == 0)
+            config.tcp_port = static_cast<uint16_t>(std::stoul(endpoint.substr(4)));
+        else
+            throw std::invalid_argument("Unknown metrics endpoint: " + endpoint);
+
+        return std::make_unique<pie::metrics::PrometheusExporter>(config, logger);
+    }
+}
+
+/**
+ * Usage: cpp_bluez_dbus_tx_example [system|session|<dbus address>] [binary log file|-] [unix:<path>|tcp:<port>]
+ */
 int main(int argc, char **argv, char **envp) {
     try {
-        auto console_logger = std::make_shared<pie::logging::ConsoleLogger>();
-        auto dbus = std::make_shared<pie::dbus::DBus>(console_logger);
-        auto gatt_sample_server = std::make_shared<pie::GattSampleServer>(dbus, console_logger);
+        auto config = to_dbus_config(argc > 1 ? argv[1] : "system");
+        auto logger = make_logger(argc > 2 ? argv[2] : "");
+        auto exporter = make_exporter(argc > 3 ? argv[3] : "", logger);
+        auto dbus = std::make_shared<pie::dbus::DBus>(logger, config);
+        auto diagnostics = std::make_shared<pie::Diagnostics>(dbus, logger);
+        auto stats = std::make_shared<pie::Stats>(dbus, logger);
+        auto gatt_sample_server = std::make_shared<pie::GattSampleServer>(dbus, logger);
         gatt_sample_server->start();
         std::string exit;
         std::cout << "Press ENTER to exit server" << std::endl;
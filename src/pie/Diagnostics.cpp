@@ -0,0 +1,254 @@
+/**
+* @file Diagnostics.cpp
+* @author Ilija Poznic
+* @date 2025
+*/
+
+#include "Diagnostics.h"
+#include "pie/dbus/helper/dbus.h"
+
+#include <pie/logging/console_helpers.h>
+#include <pie/logging/LogTag.h>
+#include <pie/logging/log.h>
+#include <pie/trace/Trace.h>
+
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+
+namespace pie {
+    struct DiagnosticsData {
+        std::shared_ptr<pie::dbus::DBus> dbus;
+        std::shared_ptr<pie::Logger> logger;
+        std::string trace_dir;
+
+        // trace is written on its own thread so DBus thread is not blocked, one dump at a time
+        std::thread dump_thread{};
+        std::atomic<bool> dumping{false};
+    };
+}
+
+namespace {
+    inline const pie::logging::LogTag &TAG = pie::logging::register_tag("Diagnostics");
+
+    DBusHandlerResult reply(const std::shared_ptr<pie::DiagnosticsData> &data, std::shared_ptr<DBusMessage> &&reply_msg) {
+        auto result = data->dbus->reply(std::move(reply_msg));
+        if (result.code != pie::dbus::DBusResultCode::Success) {
+            std::stringstream ss{};
+            ss << "Diagnostics reply error: " << result.error;
+            pie::logger::log(data->logger, TAG, pie::LogLevel::Warning, ss.str());
+            return DBUS_HANDLER_RESULT_NEED_MEMORY;
+        }
+
+        return DBUS_HANDLER_RESULT_HANDLED;
+    }
+
+    DBusHandlerResult reply_error(const std::shared_ptr<pie::DiagnosticsData> &data,
+                                  const std::shared_ptr<DBusMessage> &message,
+                                  const std::string &error,
+                                  const char *name = DBUS_ERROR_INVALID_ARGS) {
+        auto error_p = dbus_message_new_error(message.get(), name, error.c_str());
+        if (!error_p)
+            return DBUS_HANDLER_RESULT_NEED_MEMORY;
+
+        std::shared_ptr<DBusMessage> error_msg(error_p, [](DBusMessage *msg) {
+            dbus_message_unref(msg);
+        });
+        return reply(data, std::move(error_msg));
+    }
+
+    DBusHandlerResult on_message_set_log_level(const std::shared_ptr<DBusMessage> &message,
+                                               const std::shared_ptr<pie::DiagnosticsData> &data) {
+        const char *tag{nullptr};
+        const char *level{nullptr};
+        if (!dbus_message_get_args(message.get(), nullptr,
+                                   DBUS_TYPE_STRING, &tag,
+                                   DBUS_TYPE_STRING, &level,
+                                   DBUS_TYPE_INVALID))
+            return reply_error(data, message, "Expected arguments: (s tag, s level)");
+
+        auto log_level = pie::logging::log_level_from_string(level);
+        if (!log_level)
+            return reply_error(data, message, std::string{"Unknown log level: "} + level);
+
+        std::string_view tag_name{tag};
+        if (tag_name.empty() || tag_name == "*") {
+            pie::logging::set_tags_level(*log_level);
+        } else if (!pie::logging::set_tag_level(tag_name, *log_level)) {
+            return reply_error(data, message, std::string{"Unknown log tag: "} + tag);
+        }
+
+        pie::logger::log_lazy<pie::LogLevel::Information>(data->logger, TAG, [tag, level](std::ostream &os) {
+            os << "log level of tag '" << tag << "' set to " << level;
+        });
+
+        auto [success, reply_msg] = pie::dbus::message_new_method_return(data->logger, message);
+        if (!success)
+            return DBUS_HANDLER_RESULT_NEED_MEMORY;
+
+        return reply(data, std::move(reply_msg));
+    }
+
+    DBusHandlerResult on_message_get_log_levels(const std::shared_ptr<DBusMessage> &message,
+                                                const std::shared_ptr<pie::DiagnosticsData> &data) {
+        auto [success, reply_msg] = pie::dbus::message_new_method_return(data->logger, message);
+        if (!success)
+            return DBUS_HANDLER_RESULT_NEED_MEMORY;
+
+        DBusMessageIter iter{nullptr};
+        dbus_message_iter_init_append(reply_msg.get(), &iter);
+        DBusMessageIter arr_iter{nullptr};
+        // a{ss}
+        dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY, "{ss}", &arr_iter);
+        for (const auto &[name, level]: pie::logging::tag_levels()) {
+            DBusMessageIter dict_iter{nullptr};
+            dbus_message_iter_open_container(&arr_iter, DBUS_TYPE_DICT_ENTRY, nullptr, &dict_iter);
+            auto p_name = name.c_str();
+            dbus_message_iter_append_basic(&dict_iter, DBUS_TYPE_STRING, &p_name);
+            auto p_level = pie::logging::to_string(level);
+            dbus_message_iter_append_basic(&dict_iter, DBUS_TYPE_STRING, &p_level);
+            dbus_message_iter_close_container(&arr_iter, &dict_iter);
+        }
+
+        dbus_message_iter_close_container(&iter, &arr_iter);
+        return reply(data, std::move(reply_msg));
+    }
+
+    /**
+     * Write trace to new file in trace_dir, file name is generated so caller can not choose what is overwritten
+     * @return file path and number of spans
+     * @throws std::runtime_error if file can not be created or written
+     */
+    std::tuple<std::string, dbus_uint32_t> dump_trace(const std::string &trace_dir) {
+        auto file = trace_dir + "/pie_trace_XXXXXX.json";
+        auto fd = mkstemps(file.data(), 5);
+        if (fd < 0)
+            throw std::runtime_error("Failed to create trace file in " + trace_dir + ": " + strerror(errno));
+
+        auto out = fdopen(fd, "w");
+        if (!out) {
+            close(fd);
+            throw std::runtime_error("Failed to open trace file: " + file);
+        }
+
+        size_t spans{0};
+        auto failed{false};
+        try {
+            spans = pie::trace::dump(out);
+        } catch (const std::runtime_error &) {
+            failed = true;
+        }
+
+        if (std::fclose(out) != 0 || failed)
+            throw std::runtime_error("Failed to write trace file: " + file);
+
+        return {file, static_cast<dbus_uint32_t>(spans)};
+    }
+
+    /**
+     * Runs on dump thread, reply is sent with DBus::send as DBus::reply is for DBus thread only
+     */
+    void send_dump_trace_reply(const std::shared_ptr<pie::DiagnosticsData> &data,
+                               const std::shared_ptr<DBusMessage> &message) {
+        std::shared_ptr<DBusMessage> reply_msg{};
+        try {
+            auto [file, spans] = dump_trace(data->trace_dir);
+            auto [success, msg] = pie::dbus::message_new_method_return(data->logger, message);
+            if (success) {
+                auto p_file = file.c_str();
+                dbus_message_append_args(msg.get(), DBUS_TYPE_STRING, &p_file, DBUS_TYPE_UINT32, &spans,
+                                         DBUS_TYPE_INVALID);
+                reply_msg = std::move(msg);
+            }
+        } catch (const std::exception &e) {
+            if (auto error_p = dbus_message_new_error(message.get(), DBUS_ERROR_FAILED, e.what()))
+                reply_msg = std::shared_ptr<DBusMessage>(error_p, [](DBusMessage *msg) {
+                    dbus_message_unref(msg);
+                });
+        }
+
+        if (reply_msg) {
+            auto result = data->dbus->send(std::move(reply_msg));
+            if (result.code != pie::dbus::DBusResultCode::Success)
+                pie::logger::log(data->logger, TAG, pie::LogLevel::Warning, "DumpTrace reply error: " + result.error);
+        }
+
+        data->dumping.store(false, std::memory_order_release);
+    }
+
+    DBusHandlerResult on_message_dump_trace(const std::shared_ptr<DBusMessage> &message,
+                                            const std::shared_ptr<pie::DiagnosticsData> &data) {
+        if (!dbus_message_has_signature(message.get(), ""))
+            return reply_error(data, message, "Expected no arguments");
+
+        if (!pie::trace::compiled)
+            return reply_error(data, message, "Tracing disabled at compile time (PIE_ENABLE_TRACE)",
+                               DBUS_ERROR_NOT_SUPPORTED);
+
+        if (data->dumping.exchange(true, std::memory_order_acq_rel))
+            return reply_error(data, message, "Trace dump already in progress", DBUS_ERROR_LIMITS_EXCEEDED);
+
+        // previous dump has finished, its thread is about to exit
+        if (data->dump_thread.joinable())
+            data->dump_thread.join();
+
+        // handler gets message borrowed from connection, dump thread keeps its own reference
+        std::shared_ptr<DBusMessage> owned_message{dbus_message_ref(message.get()), [](DBusMessage *msg) {
+            dbus_message_unref(msg);
+        }};
+        data->dump_thread = std::thread([data, owned_message] {
+            send_dump_trace_reply(data, owned_message);
+        });
+        return DBUS_HANDLER_RESULT_HANDLED;
+    }
+
+    template<typename F>
+    pie::dbus::DBusMessageHandler make_handler(const std::weak_ptr<pie::DiagnosticsData> &weak_data, F on_message) {
+        return [weak_data, on_message](const pie::dbus::DBusMessageInfo &, std::shared_ptr<DBusMessage> message) {
+            auto data = weak_data.lock();
+            if (!data)
+                return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+
+            try {
+                return on_message(message, data);
+            } catch (const std::exception &e) {
+                std::stringstream ss;
+                ss << "on_message error: " << e.what();
+                pie::logger::log(data->logger, TAG, pie::LogLevel::Warning, ss.str());
+            }
+
+            return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+        };
+    }
+}
+
+namespace pie {
+    Diagnostics::Diagnostics(const std::shared_ptr<pie::dbus::DBus> &dbus, const std::shared_ptr<Logger> &logger,
+                             std::string trace_dir) {
+        data = std::make_shared<DiagnosticsData>();
+        data->dbus = dbus;
+        data->logger = logger;
+        data->trace_dir = std::move(trace_dir);
+
+        std::weak_ptr<DiagnosticsData> weak_data = data;
+        data->dbus->router().add_method(diagnostics_path, diagnostics_iface, "SetLogLevel",
+                                        make_handler(weak_data, on_message_set_log_level));
+        data->dbus->router().add_method(diagnostics_path, diagnostics_iface, "GetLogLevels",
+                                        make_handler(weak_data, on_message_get_log_levels));
+        data->dbus->router().add_method(diagnostics_path, diagnostics_iface, "DumpTrace",
+                                        make_handler(weak_data, on_message_dump_trace));
+    }
+
+    Diagnostics::~Diagnostics() {
+        data->dbus->router().remove(diagnostics_path);
+        if (data->dump_thread.joinable())
+            data->dump_thread.join();
+    }
+}
@@ -0,0 +1,51 @@
+/**
+* @file Diagnostics.h
+* @author Ilija Poznic
+* @date 2025
+*
+* DBus object for runtime diagnostics, e.g. change log level of single tag:
+*
+*     dbus-send --system --print-reply --dest=<name> /rs/pie/diagnostics rs.pie.Diagnostics.SetLogLevel \
+*         string:gatt::Characteristic string:Warning
+*/
+
+#pragma once
+
+#include "pie/dbus/DBus.h"
+
+#include <pie/logging/Logger.h>
+
+#include <memory>
+
+namespace pie {
+    inline const std::string diagnostics_path("/rs/pie/diagnostics");
+    inline const std::string diagnostics_iface("rs.pie.Diagnostics");
+
+    struct DiagnosticsData;
+
+    /**
+     * Methods:
+     *   SetLogLevel(s tag, s level) - tag "" or "*" sets level of all tags
+     *   GetLogLevels() -> a{ss}
+     *   DumpTrace() -> (s file, u spans) - write Chrome trace JSON to new file in trace directory,
+     *       needs PIE_ENABLE_TRACE build. Written on its own thread, reply is sent once file is complete,
+     *       one dump at a time.
+     */
+    class Diagnostics {
+    public:
+        /**
+         * @param trace_dir - directory of DumpTrace files, named pie_trace_XXXXXX.json and readable only by owner
+         */
+        Diagnostics(const std::shared_ptr<pie::dbus::DBus> &dbus, const std::shared_ptr<Logger> &logger,
+                    std::string trace_dir = "/tmp");
+
+        ~Diagnostics();
+
+        Diagnostics(const Diagnostics &) = delete;
+
+        Diagnostics &operator=(const Diagnostics &) = delete;
+
+    private:
+        std::shared_ptr<DiagnosticsData> data;
+    };
+}
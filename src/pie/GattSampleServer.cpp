@@ -11,6 +11,9 @@
 #include "bluez/HostControllerInterface.h"
 #include "bluez/LEAdvertisement.h"
 #include "logging/console_helpers.h"
+#include "logging/log.h"
+#include "metrics/Registry.h"
+#include "trace/Probe.h"
 
 
 namespace pie {
@@ -22,13 +25,14 @@ namespace pie {
         std::shared_ptr<pie::GattSampleServer> self;
         std::shared_ptr<bluez::gatt::Service> service;
         std::shared_ptr<bluez::gatt::Characteristic> rx_chr;
+        std::shared_ptr<bluez::gatt::Characteristic> tx_chr;
         std::shared_ptr<bluez::LEAdvertisement> advertisement;
         bluez::gatt::ServerState state{bluez::gatt::ServerState::Stopped};
     };
 }
 
 namespace {
-    inline const std::string TAG{"GattSampleServer"};
+    inline const pie::logging::LogTag &TAG = pie::logging::register_tag("GattSampleServer");
     inline const char *if_rs_pie = "rs.pie";
     inline const char *path_rs_pie = "/rs/pie";
     inline const char *path_rs_pie_gatt_sample_server = "/rs/pie/gatt_sample_server";
@@ -37,50 +41,44 @@ namespace {
         const pie::dbus::DBusMessageInfo &msg_info,
         const std::shared_ptr<DBusMessage> &message,
         const std::shared_ptr<pie::GattSampleServerData> &data) {
-        if (pie::dbus::object_manager::is_method(msg_info,
-                                                 data->path, pie::dbus::object_manager::Methods::GetManagedObject)) {
-            //  method: ObjectManager_GetManagedObject
-            {
-                std::stringstream ss{};
-                ss << "on_message: path: " << msg_info.path;;
-                ss << ", method: ObjectManager_GetManagedObject";
-                pie::logger::log_if_debug(data->logger, TAG, pie::LogLevel::Trace,
-                                          ss.str());
-            }
-
-            auto [success, reply_msg] = pie::dbus::message_new_method_return(data->logger, message);
-            if (!success)
-                return DBUS_HANDLER_RESULT_NEED_MEMORY;
-
-            DBusMessageIter iter{nullptr};
-            dbus_message_iter_init_append(reply_msg.get(), &iter);
-            DBusMessageIter dict_iter{nullptr};
-            // {oa{sa{sv}}}
-            dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY,
-                                             "{oa{sa{sv}}}", &dict_iter);
-            // get managed objects (No Need as GattSampleServer has no implemented interface)
-            //DBusMessageIter srv_iter{nullptr};
-
-            // adding service(s)
-            data->service->get_managed_objects(&dict_iter);
-
-            dbus_message_iter_close_container(&iter, &dict_iter);
-            dbus_message_iter_init_closed(&iter);
-
-            auto result = data->dbus->reply(std::move(reply_msg));
-            if (result.code != pie::dbus::DBusResultCode::Success) {
-                std::stringstream ss{};
-                ss << "response on_message: path: " << msg_info.path;;
-                ss << ", method: ObjectManager_GetManagedObject";
-                ss << ", error: " << result.error;
-                data->logger->log(pie::LogLevel::Warning, ss.str());
-                return DBUS_HANDLER_RESULT_NEED_MEMORY;
-            }
-
-            return DBUS_HANDLER_RESULT_HANDLED;
+        pie::logger::log_lazy<pie::LogLevel::Trace>(data->logger, TAG, [&msg_info](std::ostream &os) {
+            os << "on_message: path: " << msg_info.path << ", method: ObjectManager_GetManagedObject";
+        });
+
+        static auto &requests = pie::metrics::counter("gatt_get_managed_objects_total", {},
+                                                      "GetManagedObjects calls of GATT application");
+        requests.add();
+
+        auto [success, reply_msg] = pie::dbus::message_new_method_return(data->logger, message);
+        if (!success)
+            return DBUS_HANDLER_RESULT_NEED_MEMORY;
+
+        DBusMessageIter iter{nullptr};
+        dbus_message_iter_init_append(reply_msg.get(), &iter);
+        DBusMessageIter dict_iter{nullptr};
+        // {oa{sa{sv}}}
+        dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY,
+                                         "{oa{sa{sv}}}", &dict_iter);
+        // get managed objects (No Need as GattSampleServer has no implemented interface)
+        //DBusMessageIter srv_iter{nullptr};
+
+        // adding service(s)
+        data->service->get_managed_objects(&dict_iter);
+
+        dbus_message_iter_close_container(&iter, &dict_iter);
+        dbus_message_iter_init_closed(&iter);
+
+        auto result = data->dbus->reply(std::move(reply_msg));
+        if (result.code != pie::dbus::DBusResultCode::Success) {
+            std::stringstream ss{};
+            ss << "response on_message: path: " << msg_info.path;;
+            ss << ", method: ObjectManager_GetManagedObject";
+            ss << ", error: " << result.error;
+            data->logger->log(pie::LogLevel::Warning, ss.str());
+            return DBUS_HANDLER_RESULT_NEED_MEMORY;
         }
 
-        return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+        return DBUS_HANDLER_RESULT_HANDLED;
     }
 }
 
@@ -95,7 +93,22 @@ namespace pie {
         std::shared_ptr<pie::GattSampleServer> self(this, [](pie::GattSampleServer *server) {
         });
         data->self = self;
-        data->dbus->subscribe(self);;
+        std::weak_ptr<GattSampleServerData> weak_data = data;
+        data->dbus->router().add_method(
+            data->path, pie::dbus::object_manager::iface,
+            pie::dbus::object_manager::to_string(pie::dbus::object_manager::Methods::GetManagedObject),
+            [weak_data](const dbus::DBusMessageInfo &msg_info, std::shared_ptr<DBusMessage> message) {
+                auto data = weak_data.lock();
+                if (!data)
+                    return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+
+                try {
+                    return on_message_obj_mng_get_managed_object(msg_info, message, data);
+                } catch (...) {
+                }
+
+                return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+            });
         data->hci = std::make_shared<pie::bluez::HostControllerInterface>(
             "/org/bluez/hci0", dbus, logger);
 
@@ -124,6 +137,19 @@ namespace pie {
 
         data->service->add_characteristic(data->rx_chr);
 
+        // create tx_characteristic, values written to rx are echoed as notifications
+        data->tx_chr = std::make_shared<pie::bluez::gatt::Characteristic>(
+            tx_uuid,
+            data->service,
+            std::vector{
+                bluez::gatt::characteristic::Flag::Notify
+            },
+            nullptr,
+            dbus,
+            logger);
+
+        data->service->add_characteristic(data->tx_chr);
+
         std::stringstream ss{};
         ss << data->path << "/le_advertisement";
         data->advertisement = std::make_shared<bluez::LEAdvertisement>(ss.str(), dbus, logger);
@@ -132,11 +158,12 @@ namespace pie {
             service_uuid,
         });
 
-        data->advertisement->name(TAG);
+        data->advertisement->name(TAG.name());
     }
 
     GattSampleServer::~GattSampleServer() {
         GattSampleServer::stop();
+        data->dbus->router().remove(data->path);
         pie::logger::log_if_debug(data->logger,
                                   TAG, LogLevel::Trace,
                                   "GattSampleServer::~GattSampleServer()");
@@ -153,13 +180,13 @@ namespace pie {
             data->state = pie::bluez::gatt::ServerState::Running;
         } catch (const pie::bluez::gatt::Exception &ex) {
             std::stringstream ss{};
-            ss << "Failed to start " << TAG;
+            ss << "Failed to start " << TAG.name();
             ss << ", error: " << ex.what();
             data->logger->log(LogLevel::Warning, ss.str());
             data->state = pie::bluez::gatt::ServerState::Error;
         } catch (...) {
             std::stringstream ss{};
-            ss << "Failed to start " << TAG;
+            ss << "Failed to start " << TAG.name();
             data->logger->log(LogLevel::Warning, ss.str());
             data->state = pie::bluez::gatt::ServerState::Error;
         }
@@ -175,12 +202,12 @@ namespace pie {
             data->state = pie::bluez::gatt::ServerState::Stopped;
         } catch (const pie::bluez::gatt::Exception &ex) {
             std::stringstream ss{};
-            ss << "Failed to stop " << TAG;
+            ss << "Failed to stop " << TAG.name();
             ss << ", error: " << ex.what();
             data->logger->log(LogLevel::Warning, ss.str());
         } catch (...) {
             std::stringstream ss{};
-            ss << "Failed to stop " << TAG;
+            ss << "Failed to stop " << TAG.name();
             data->logger->log(LogLevel::Warning, ss.str());
         }
     }
@@ -189,19 +216,19 @@ namespace pie {
         return data->state;
     }
 
-    void GattSampleServer::on_value_changed(const std::string &uuid, const std::vector<uint8_t> &value) {
-        std::stringstream ss{};
-        ss << "Value changed for characteristic: " << uuid;
-        ss << ", value: ";
-        for (auto &byte: value) {
-            auto ch = static_cast<char>(byte);
-            if (isalnum(ch))
-                ss << ch;
-            else
-                ss << ".";
+    void GattSampleServer::on_value_changed(const std::string &uuid, const pie::dbus::ByteView &value) {
+        PIE_PROBE(value_changed, uuid.c_str(), static_cast<uint64_t>(value.size()));
+        static const auto &format = pie::logging::register_format(
+            TAG, "Value changed for characteristic: {}, size: {}, value: {}");
+        pie::logger::log_format<LogLevel::Information>(data->logger, format, uuid, value.size(),
+                                                       pie::logging::LogBytes{value.data(), value.size()});
+
+        auto result = data->tx_chr->notify(value.data(), value.size());
+        if (result == bluez::gatt::NotifyResult::Full || result == bluez::gatt::NotifyResult::TooLarge) {
+            static const auto &echo_format = pie::logging::register_format(
+                TAG, "Echo dropped, notify queue full or value over MTU, size: {}");
+            pie::logger::log_format<LogLevel::Debug>(data->logger, echo_format, value.size());
         }
-
-        data->logger->log(LogLevel::Information, ss.str());
     }
 
 
@@ -212,15 +239,17 @@ namespace pie {
             if (result != DBUS_HANDLER_RESULT_NOT_YET_HANDLED)
                 return result;
 
+            result = data->tx_chr->on_message(msg_info, message);
+            if (result != DBUS_HANDLER_RESULT_NOT_YET_HANDLED)
+                return result;
+
             result = data->advertisement->on_message(msg_info, message);
             if (result != DBUS_HANDLER_RESULT_NOT_YET_HANDLED)
                 return result;
 
-            if (msg_info.path == data->path) {
-                result = on_message_obj_mng_get_managed_object(msg_info, message, data);
-                if (result != DBUS_HANDLER_RESULT_NOT_YET_HANDLED)
-                    return result;
-            }
+            if (pie::dbus::object_manager::is_method(msg_info, data->path,
+                                                     pie::dbus::object_manager::Methods::GetManagedObject))
+                return on_message_obj_mng_get_managed_object(msg_info, message, data);
         } catch (...) {
         }
 
@@ -18,6 +18,7 @@
 namespace pie {
     inline const std::string service_uuid("23500001-da00-49ad-9923-296889f1d83d");
     inline const std::string rx_uuid("23500002-da00-49ad-9923-296889f1d83d");
+    inline const std::string tx_uuid("23500003-da00-49ad-9923-296889f1d83d");
 
     struct GattSampleServerData;
 
@@ -36,7 +37,7 @@ namespace pie {
 
         [[nodiscard]] bluez::gatt::ServerState state() const override;
 
-        void on_value_changed(const std::string &uuid, const std::vector<uint8_t> &value) override;
+        void on_value_changed(const std::string &uuid, const pie::dbus::ByteView &value) override;
 
         DBusHandlerResult on_message(
             const dbus::DBusMessageInfo &msg_info,
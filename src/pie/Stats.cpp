@@ -0,0 +1,273 @@
+/**
+* @file Stats.cpp
+* @author Ilija Poznic
+* @date 2025
+*/
+
+#include "Stats.h"
+#include "pie/dbus/helper/dbus.h"
+#include "pie/metrics/Registry.h"
+
+#include <pie/logging/console_helpers.h>
+
+#include <array>
+#include <cstring>
+#include <sstream>
+
+namespace pie {
+    struct StatsData {
+        std::shared_ptr<pie::dbus::DBus> dbus;
+        std::shared_ptr<pie::Logger> logger;
+    };
+}
+
+namespace {
+    inline const pie::logging::LogTag &TAG = pie::logging::register_tag("Stats");
+
+    void append_entry(DBusMessageIter *iter, const std::string &key, uint64_t value) {
+        DBusMessageIter dict_iter{nullptr};
+        dbus_message_iter_open_container(iter, DBUS_TYPE_DICT_ENTRY, nullptr, &dict_iter);
+        auto p_key = key.c_str();
+        dbus_message_iter_append_basic(&dict_iter, DBUS_TYPE_STRING, &p_key);
+        dbus_uint64_t p_value = value;
+        dbus_message_iter_append_basic(&dict_iter, DBUS_TYPE_UINT64, &p_value);
+        dbus_message_iter_close_container(iter, &dict_iter);
+    }
+
+    // a{st}
+    void append_counters(const pie::StatsData &, DBusMessageIter *iter) {
+        DBusMessageIter arr_iter{nullptr};
+        dbus_message_iter_open_container(iter, DBUS_TYPE_ARRAY, "{st}", &arr_iter);
+        for (auto metric: pie::metrics::metrics()) {
+            if (metric->type == pie::metrics::MetricType::Counter)
+                append_entry(&arr_iter, pie::metrics::full_name(*metric), metric->counter->value());
+        }
+
+        dbus_message_iter_close_container(iter, &arr_iter);
+    }
+
+    // a{s(tttttt)}
+    void append_histograms(const pie::StatsData &, DBusMessageIter *iter) {
+        DBusMessageIter arr_iter{nullptr};
+        dbus_message_iter_open_container(iter, DBUS_TYPE_ARRAY, "{s(tttttt)}", &arr_iter);
+        for (auto metric: pie::metrics::metrics()) {
+            if (metric->type != pie::metrics::MetricType::Histogram)
+                continue;
+
+            auto snapshot = metric->histogram->snapshot();
+            DBusMessageIter dict_iter{nullptr};
+            dbus_message_iter_open_container(&arr_iter, DBUS_TYPE_DICT_ENTRY, nullptr, &dict_iter);
+            auto name = pie::metrics::full_name(*metric);
+            auto p_name = name.c_str();
+            dbus_message_iter_append_basic(&dict_iter, DBUS_TYPE_STRING, &p_name);
+
+            DBusMessageIter struct_iter{nullptr};
+            dbus_message_iter_open_container(&dict_iter, DBUS_TYPE_STRUCT, nullptr, &struct_iter);
+            for (dbus_uint64_t value: {
+                     snapshot.count, snapshot.sum, snapshot.percentile(50), snapshot.percentile(90),
+                     snapshot.percentile(99), snapshot.max
+                 }) {
+                dbus_message_iter_append_basic(&struct_iter, DBUS_TYPE_UINT64, &value);
+            }
+
+            dbus_message_iter_close_container(&dict_iter, &struct_iter);
+            dbus_message_iter_close_container(&arr_iter, &dict_iter);
+        }
+
+        dbus_message_iter_close_container(iter, &arr_iter);
+    }
+
+    // a{st}
+    void append_queue(const pie::StatsData &data, DBusMessageIter *iter) {
+        auto stats = data.dbus->stats();
+        DBusMessageIter arr_iter{nullptr};
+        dbus_message_iter_open_container(iter, DBUS_TYPE_ARRAY, "{st}", &arr_iter);
+        append_entry(&arr_iter, "depth", stats.queue_depth);
+        append_entry(&arr_iter, "high_water_mark", stats.queue_high_water_mark);
+        append_entry(&arr_iter, "rejected", stats.queue_rejected);
+        append_entry(&arr_iter, "dropped", stats.queue_dropped);
+        append_entry(&arr_iter, "batches", stats.batches);
+        append_entry(&arr_iter, "commands", stats.commands);
+        dbus_message_iter_close_container(iter, &arr_iter);
+    }
+
+    // a{st}
+    void append_stalls(const pie::StatsData &data, DBusMessageIter *iter) {
+        auto stalls = data.dbus->stalls();
+        DBusMessageIter arr_iter{nullptr};
+        dbus_message_iter_open_container(iter, DBUS_TYPE_ARRAY, "{st}", &arr_iter);
+        append_entry(&arr_iter, "iterations", stalls.iterations);
+        append_entry(&arr_iter, "handlers", stalls.handlers);
+        dbus_message_iter_close_container(iter, &arr_iter);
+    }
+
+    // a(sssttt)
+    void append_stall_offenders(const pie::StatsData &data, DBusMessageIter *iter) {
+        auto stalls = data.dbus->stalls();
+        DBusMessageIter arr_iter{nullptr};
+        dbus_message_iter_open_container(iter, DBUS_TYPE_ARRAY, "(sssttt)", &arr_iter);
+        for (const auto &stall: stalls.worst) {
+            DBusMessageIter struct_iter{nullptr};
+            dbus_message_iter_open_container(&arr_iter, DBUS_TYPE_STRUCT, nullptr, &struct_iter);
+            for (const auto &text: {stall.path, stall.iface, stall.member}) {
+                auto p_text = text.c_str();
+                dbus_message_iter_append_basic(&struct_iter, DBUS_TYPE_STRING, &p_text);
+            }
+
+            for (dbus_uint64_t value: {stall.count, stall.max_ns, stall.last_ns})
+                dbus_message_iter_append_basic(&struct_iter, DBUS_TYPE_UINT64, &value);
+
+            dbus_message_iter_close_container(&arr_iter, &struct_iter);
+        }
+
+        dbus_message_iter_close_container(iter, &arr_iter);
+    }
+
+    struct Property {
+        const char *name;
+        const char *signature;
+        void (*append)(const pie::StatsData &data, DBusMessageIter *iter);
+    };
+
+    constexpr std::array<Property, 5> properties{
+        {
+            {"Counters", "a{st}", append_counters},
+            {"Histograms", "a{s(tttttt)}", append_histograms},
+            {"Queue", "a{st}", append_queue},
+            {"Stalls", "a{st}", append_stalls},
+            {"StallOffenders", "a(sssttt)", append_stall_offenders},
+        }
+    };
+
+    void append_variant(const pie::StatsData &data, const Property &property, DBusMessageIter *iter) {
+        DBusMessageIter var_iter{nullptr};
+        dbus_message_iter_open_container(iter, DBUS_TYPE_VARIANT, property.signature, &var_iter);
+        property.append(data, &var_iter);
+        dbus_message_iter_close_container(iter, &var_iter);
+    }
+
+    DBusHandlerResult reply(const std::shared_ptr<pie::StatsData> &data, std::shared_ptr<DBusMessage> &&reply_msg) {
+        auto result = data->dbus->reply(std::move(reply_msg));
+        if (result.code != pie::dbus::DBusResultCode::Success) {
+            std::stringstream ss{};
+            ss << "Stats reply error: " << result.error;
+            pie::logger::log(data->logger, TAG, pie::LogLevel::Warning, ss.str());
+            return DBUS_HANDLER_RESULT_NEED_MEMORY;
+        }
+
+        return DBUS_HANDLER_RESULT_HANDLED;
+    }
+
+    DBusHandlerResult reply_error(const std::shared_ptr<pie::StatsData> &data,
+                                  const std::shared_ptr<DBusMessage> &message,
+                                  const char *name,
+                                  const std::string &error) {
+        auto error_p = dbus_message_new_error(message.get(), name, error.c_str());
+        if (!error_p)
+            return DBUS_HANDLER_RESULT_NEED_MEMORY;
+
+        std::shared_ptr<DBusMessage> error_msg(error_p, [](DBusMessage *msg) {
+            dbus_message_unref(msg);
+        });
+        return reply(data, std::move(error_msg));
+    }
+
+    DBusHandlerResult on_message_properties_get(const std::shared_ptr<DBusMessage> &message,
+                                                const std::shared_ptr<pie::StatsData> &data) {
+        const char *iface{nullptr};
+        const char *name{nullptr};
+        if (!dbus_message_get_args(message.get(), nullptr,
+                                   DBUS_TYPE_STRING, &iface,
+                                   DBUS_TYPE_STRING, &name,
+                                   DBUS_TYPE_INVALID))
+            return reply_error(data, message, DBUS_ERROR_INVALID_ARGS, "Expected arguments: (s iface, s name)");
+
+        if (pie::stats_iface != iface)
+            return reply_error(data, message, DBUS_ERROR_UNKNOWN_INTERFACE, std::string{"Unknown interface: "} + iface);
+
+        for (const auto &property: properties) {
+            if (std::strcmp(property.name, name) != 0)
+                continue;
+
+            auto [success, reply_msg] = pie::dbus::message_new_method_return(data->logger, message);
+            if (!success)
+                return DBUS_HANDLER_RESULT_NEED_MEMORY;
+
+            DBusMessageIter iter{nullptr};
+            dbus_message_iter_init_append(reply_msg.get(), &iter);
+            append_variant(*data, property, &iter);
+            return reply(data, std::move(reply_msg));
+        }
+
+        return reply_error(data, message, DBUS_ERROR_UNKNOWN_PROPERTY, std::string{"Unknown property: "} + name);
+    }
+
+    DBusHandlerResult on_message_properties_get_all(const std::shared_ptr<DBusMessage> &message,
+                                                    const std::shared_ptr<pie::StatsData> &data) {
+        const char *iface{nullptr};
+        if (!dbus_message_get_args(message.get(), nullptr, DBUS_TYPE_STRING, &iface, DBUS_TYPE_INVALID))
+            return reply_error(data, message, DBUS_ERROR_INVALID_ARGS, "Expected arguments: (s iface)");
+
+        auto [success, reply_msg] = pie::dbus::message_new_method_return(data->logger, message);
+        if (!success)
+            return DBUS_HANDLER_RESULT_NEED_MEMORY;
+
+        DBusMessageIter iter{nullptr};
+        dbus_message_iter_init_append(reply_msg.get(), &iter);
+        DBusMessageIter props_iter{nullptr};
+        dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY, "{sv}", &props_iter);
+        // other interfaces of the object have no properties
+        if (pie::stats_iface == iface) {
+            for (const auto &property: properties) {
+                DBusMessageIter dict_iter{nullptr};
+                dbus_message_iter_open_container(&props_iter, DBUS_TYPE_DICT_ENTRY, nullptr, &dict_iter);
+                dbus_message_iter_append_basic(&dict_iter, DBUS_TYPE_STRING, &property.name);
+                append_variant(*data, property, &dict_iter);
+                dbus_message_iter_close_container(&props_iter, &dict_iter);
+            }
+        }
+
+        dbus_message_iter_close_container(&iter, &props_iter);
+        return reply(data, std::move(reply_msg));
+    }
+
+    template<typename F>
+    pie::dbus::DBusMessageHandler make_handler(const std::weak_ptr<pie::StatsData> &weak_data, F on_message) {
+        return [weak_data, on_message](const pie::dbus::DBusMessageInfo &, std::shared_ptr<DBusMessage> message) {
+            auto data = weak_data.lock();
+            if (!data)
+                return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+
+            try {
+                return on_message(message, data);
+            } catch (const std::exception &e) {
+                std::stringstream ss;
+                ss << "on_message error: " << e.what();
+                pie::logger::log(data->logger, TAG, pie::LogLevel::Warning, ss.str());
+            }
+
+            return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+        };
+    }
+}
+
+namespace pie {
+    Stats::Stats(const std::shared_ptr<pie::dbus::DBus> &dbus, const std::shared_ptr<Logger> &logger) {
+        data = std::make_shared<StatsData>();
+        data->dbus = dbus;
+        data->logger = logger;
+
+        std::weak_ptr<StatsData> weak_data = data;
+        auto &router = data->dbus->router();
+        router.add_method(stats_path, pie::dbus::properties::iface,
+                          pie::dbus::properties::to_string(pie::dbus::properties::Methods::Get),
+                          make_handler(weak_data, on_message_properties_get));
+        router.add_method(stats_path, pie::dbus::properties::iface,
+                          pie::dbus::properties::to_string(pie::dbus::properties::Methods::GetAll),
+                          make_handler(weak_data, on_message_properties_get_all));
+    }
+
+    Stats::~Stats() {
+        data->dbus->router().remove(stats_path);
+    }
+}
@@ -0,0 +1,46 @@
+/**
+* @file Stats.h
+* @author Ilija Poznic
+* @date 2025
+*
+* Read only DBus view of pie::metrics and DBus queue counters, e.g.:
+*
+*     busctl --user get-property <name> /rs/pie/stats rs.pie.Stats Histograms
+*/
+
+#pragma once
+
+#include "pie/dbus/DBus.h"
+
+#include <pie/logging/Logger.h>
+
+#include <memory>
+
+namespace pie {
+    inline const std::string stats_path("/rs/pie/stats");
+    inline const std::string stats_iface("rs.pie.Stats");
+
+    struct StatsData;
+
+    /**
+     * org.freedesktop.DBus.Properties (Get, GetAll) of interface rs.pie.Stats:
+     *   Counters a{st} - "name{labels}" -> value
+     *   Histograms a{s(tttttt)} - "name{labels}" -> (count, sum, p50, p90, p99, max)
+     *   Queue a{st} - DBus command queue and batch counters
+     *   Stalls a{st} - loop iterations and handlers over time budget
+     *   StallOffenders a(sssttt) - (path, iface, member, count, max_ns, last_ns) of slowest handlers
+     */
+    class Stats {
+    public:
+        Stats(const std::shared_ptr<pie::dbus::DBus> &dbus, const std::shared_ptr<Logger> &logger);
+
+        ~Stats();
+
+        Stats(const Stats &) = delete;
+
+        Stats &operator=(const Stats &) = delete;
+
+    private:
+        std::shared_ptr<StatsData> data;
+    };
+}
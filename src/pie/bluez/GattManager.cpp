@@ -9,9 +9,11 @@
 #include "pie/bluez/gatt/Exception.h"
 #include "pie/bluez/gatt/helper/manager.h"
 #include "pie/bluez/helper/bluez.h"
+#include "pie/logging/LogTag.h"
+#include "pie/metrics/Registry.h"
 
 namespace {
-    inline const std::string TAG{"GattManager"};
+    inline const pie::logging::LogTag &TAG = pie::logging::register_tag("GattManager");
 }
 
 namespace pie::bluez {
@@ -36,7 +38,7 @@ namespace pie::bluez {
 
     GattManager::~GattManager() {
         pie::logger::log_if_debug(
-            data->logger, LogLevel::Trace, "GattManager::~GattManager()");
+            data->logger, TAG, LogLevel::Trace, "GattManager::~GattManager()");
     }
 
     void GattManager::register_application(std::string const &path) const {
@@ -60,7 +62,11 @@ namespace pie::bluez {
         dbus_message_iter_init_closed(&iter);
 
         auto result = data->dbus->send(std::move(msg));
-        if (result.code != dbus::DBusResultCode::Success) {
+        auto success = result.code == dbus::DBusResultCode::Success;
+        pie::metrics::counter("gatt_application_registrations_total",
+                              success ? "result=\"success\"" : "result=\"error\"",
+                              "RegisterApplication calls by result").add();
+        if (!success) {
             std::stringstream ss{};
             ss << "Failed to register application " << path;
             ss << ", error: " << result.error;
@@ -22,7 +22,7 @@ namespace pie::bluez {
 
 
 namespace {
-    inline const std::string TAG = "HostControllerInterface";
+    inline const pie::logging::LogTag &TAG = pie::logging::register_tag("HostControllerInterface");
 }
 
 
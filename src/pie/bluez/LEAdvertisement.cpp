@@ -9,6 +9,8 @@
 #include "pie/dbus/helper/dbus.h"
 
 #include <pie/logging/console_helpers.h>
+#include <pie/logging/log.h>
+#include <pie/metrics/Registry.h>
 
 namespace pie::bluez {
     struct LEAdvertisementData {
@@ -25,7 +27,7 @@ namespace pie::bluez {
 }
 
 namespace {
-    inline const std::string TAG = "LEAdvertisement";
+    inline const pie::logging::LogTag &TAG = pie::logging::register_tag("LEAdvertisement");
 
     void append_properties(const std::shared_ptr<pie::bluez::LEAdvertisementData> &data,
                            const std::shared_ptr<DBusMessage> &reply,
@@ -64,97 +66,112 @@ namespace {
     DBusHandlerResult on_message_properties_get_all(const pie::dbus::DBusMessageInfo &msg_info,
                                                     const std::shared_ptr<DBusMessage> &message,
                                                     const std::shared_ptr<pie::bluez::LEAdvertisementData> &data) {
-        if (pie::dbus::properties::is_method(
-            msg_info, data->path,
-            pie::dbus::properties::Methods::GetAll)) {
-            std::stringstream ss{};
-            ss << "on_message: path: " << msg_info.path;;
-            ss << ", method: Properties_GetAll";
-            pie::logger::log_if_debug(data->logger, TAG, pie::LogLevel::Trace,
-                                      ss.str());
-            auto [success, reply_msg] = pie::dbus::message_new_method_return(data->logger, message);
-            if (!success)
-                return DBUS_HANDLER_RESULT_NEED_MEMORY;
-
-            DBusMessageIter iter{nullptr};
-            dbus_message_iter_init_append(reply_msg.get(), &iter);
-            append_properties(data, reply_msg, &iter);
-            dbus_message_iter_init_closed(&iter);
-
-            auto result = data->dbus->reply(std::move(reply_msg));
-            if (result.code != pie::dbus::DBusResultCode::Success) {
-                ss << ", error: " << result.error;
-                pie::logger::log_if_debug(data->logger, TAG, pie::LogLevel::Warning, ss.str());
-                return DBUS_HANDLER_RESULT_NEED_MEMORY;
-            }
+        pie::logger::log_lazy<pie::LogLevel::Trace>(data->logger, TAG, [&msg_info](std::ostream &os) {
+            os << "on_message: path: " << msg_info.path << ", method: Properties_GetAll";
+        });
+        static auto &reads = pie::metrics::counter("le_advertisement_property_reads_total", {},
+                                                   "Properties.GetAll calls of LE advertisements");
+        reads.add();
+
+        auto [success, reply_msg] = pie::dbus::message_new_method_return(data->logger, message);
+        if (!success)
+            return DBUS_HANDLER_RESULT_NEED_MEMORY;
 
-            return DBUS_HANDLER_RESULT_HANDLED;
+        DBusMessageIter iter{nullptr};
+        dbus_message_iter_init_append(reply_msg.get(), &iter);
+        append_properties(data, reply_msg, &iter);
+        dbus_message_iter_init_closed(&iter);
+
+        auto result = data->dbus->reply(std::move(reply_msg));
+        if (result.code != pie::dbus::DBusResultCode::Success) {
+            pie::logger::log_lazy<pie::LogLevel::Warning>(data->logger, TAG, [&](std::ostream &os) {
+                os << "on_message: path: " << msg_info.path << ", method: Properties_GetAll";
+                os << ", error: " << result.error;
+            });
+            return DBUS_HANDLER_RESULT_NEED_MEMORY;
         }
 
-        return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+        return DBUS_HANDLER_RESULT_HANDLED;
     }
 
     DBusHandlerResult on_message_obj_mng_get_mng_objs(const pie::dbus::DBusMessageInfo &msg_info,
                                                       const std::shared_ptr<DBusMessage> &message,
                                                       const std::shared_ptr<pie::bluez::LEAdvertisementData> &data) {
-        if (pie::dbus::object_manager::is_method(
-            msg_info, data->path,
-            pie::dbus::object_manager::Methods::GetManagedObject)) {
-            std::stringstream ss{};
-            ss << "on_message: path: " << msg_info.path;;
-            ss << ", method: ObjectManager_GetManagedObject";
-            pie::logger::log_if_debug(data->logger, TAG, pie::LogLevel::Trace,
-                                      ss.str());
-
-            auto [success, reply_msg] = pie::dbus::message_new_method_return(data->logger, message);
-            if (!success)
-                return DBUS_HANDLER_RESULT_NEED_MEMORY;
+        pie::logger::log_lazy<pie::LogLevel::Trace>(data->logger, TAG, [&msg_info](std::ostream &os) {
+            os << "on_message: path: " << msg_info.path << ", method: ObjectManager_GetManagedObject";
+        });
 
-            DBusMessageIter iter{nullptr};
-            dbus_message_iter_init_append(reply_msg.get(), &iter);
-            DBusMessageIter dict_iter{nullptr};
-            // {oa{sa{sv}}}
-            dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY,
-                                             "{oa{sa{sv}}}", &dict_iter);
-            // get managed objects
-            DBusMessageIter srv_iter{nullptr};
-            // "os{sa{sv}}
-            dbus_message_iter_open_container(&dict_iter, DBUS_TYPE_DICT_ENTRY,
-                                             nullptr, &srv_iter);
-
-            auto path = data->path.c_str();
-            dbus_message_iter_append_basic(&srv_iter, DBUS_TYPE_OBJECT_PATH, &path);
-
-            DBusMessageIter arr_iter{nullptr};
-            dbus_message_iter_open_container(&srv_iter, DBUS_TYPE_ARRAY,
-                                             "{sa{sv}}", &arr_iter);
-
-            DBusMessageIter if_dict_iter{nullptr};
-            dbus_message_iter_open_container(&arr_iter, DBUS_TYPE_DICT_ENTRY,
-                                             nullptr, &if_dict_iter);
-
-            auto iface = data->iface.c_str();
-            dbus_message_iter_append_basic(&if_dict_iter, DBUS_TYPE_STRING, &iface);
-
-            append_properties(data, reply_msg, &if_dict_iter);
-
-            dbus_message_iter_close_container(&arr_iter, &if_dict_iter);
-            dbus_message_iter_close_container(&srv_iter, &arr_iter);
-            dbus_message_iter_close_container(&dict_iter, &srv_iter);
-            dbus_message_iter_close_container(&iter, &dict_iter);
-            dbus_message_iter_init_closed(&iter);
-
-            auto result = data->dbus->reply(std::move(reply_msg));
-            if (result.code != pie::dbus::DBusResultCode::Success) {
-                ss << ", error: " << result.error;
-                pie::logger::log_if_debug(data->logger, TAG, pie::LogLevel::Warning, ss.str());
-                return DBUS_HANDLER_RESULT_NEED_MEMORY;
-            }
+        auto [success, reply_msg] = pie::dbus::message_new_method_return(data->logger, message);
+        if (!success)
+            return DBUS_HANDLER_RESULT_NEED_MEMORY;
 
-            return DBUS_HANDLER_RESULT_HANDLED;
+        DBusMessageIter iter{nullptr};
+        dbus_message_iter_init_append(reply_msg.get(), &iter);
+        DBusMessageIter dict_iter{nullptr};
+        // {oa{sa{sv}}}
+        dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY,
+                                         "{oa{sa{sv}}}", &dict_iter);
+        // get managed objects
+        DBusMessageIter srv_iter{nullptr};
+        // "os{sa{sv}}
+        dbus_message_iter_open_container(&dict_iter, DBUS_TYPE_DICT_ENTRY,
+                                         nullptr, &srv_iter);
+
+        auto path = data->path.c_str();
+        dbus_message_iter_append_basic(&srv_iter, DBUS_TYPE_OBJECT_PATH, &path);
+
+        DBusMessageIter arr_iter{nullptr};
+        dbus_message_iter_open_container(&srv_iter, DBUS_TYPE_ARRAY,
+                                         "{sa{sv}}", &arr_iter);
+
+        DBusMessageIter if_dict_iter{nullptr};
+        dbus_message_iter_open_container(&arr_iter, DBUS_TYPE_DICT_ENTRY,
+                                         nullptr, &if_dict_iter);
+
+        auto iface = data->iface.c_str();
+        dbus_message_iter_append_basic(&if_dict_iter, DBUS_TYPE_STRING, &iface);
+
+        append_properties(data, reply_msg, &if_dict_iter);
+
+        dbus_message_iter_close_container(&arr_iter, &if_dict_iter);
+        dbus_message_iter_close_container(&srv_iter, &arr_iter);
+        dbus_message_iter_close_container(&dict_iter, &srv_iter);
+        dbus_message_iter_close_container(&iter, &dict_iter);
+        dbus_message_iter_init_closed(&iter);
+
+        auto result = data->dbus->reply(std::move(reply_msg));
+        if (result.code != pie::dbus::DBusResultCode::Success) {
+            pie::logger::log_lazy<pie::LogLevel::Warning>(data->logger, TAG, [&](std::ostream &os) {
+                os << "on_message: path: " << msg_info.path << ", method: ObjectManager_GetManagedObject";
+                os << ", error: " << result.error;
+            });
+            return DBUS_HANDLER_RESULT_NEED_MEMORY;
         }
 
-        return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+        return DBUS_HANDLER_RESULT_HANDLED;
+    }
+
+    using Handler = DBusHandlerResult (*)(const pie::dbus::DBusMessageInfo &msg_info,
+                                          const std::shared_ptr<DBusMessage> &message,
+                                          const std::shared_ptr<pie::bluez::LEAdvertisementData> &data);
+
+    pie::dbus::DBusMessageHandler to_route_handler(const std::shared_ptr<pie::bluez::LEAdvertisementData> &data,
+                                                   Handler handler) {
+        std::weak_ptr<pie::bluez::LEAdvertisementData> weak_data = data;
+        return [weak_data, handler](const pie::dbus::DBusMessageInfo &msg_info, std::shared_ptr<DBusMessage> message) {
+            auto data = weak_data.lock();
+            if (!data)
+                return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+
+            try {
+                return handler(msg_info, message, data);
+            } catch (const std::exception &e) {
+                std::stringstream ss;
+                ss << "onmessage error: " << e.what();
+                pie::logger::log(data->logger, TAG, pie::LogLevel::Error, ss.str());
+                return DBUS_HANDLER_RESULT_NEED_MEMORY;
+            }
+        };
     }
 }
 
@@ -166,9 +183,18 @@ namespace pie::bluez {
         data->path = std::move(path);
         data->dbus = std::move(dbus);
         data->logger = std::move(logger);
+
+        auto &router = data->dbus->router();
+        router.add_method(data->path, pie::dbus::properties::iface,
+                          pie::dbus::properties::to_string(pie::dbus::properties::Methods::GetAll),
+                          to_route_handler(data, on_message_properties_get_all));
+        router.add_method(data->path, pie::dbus::object_manager::iface,
+                          pie::dbus::object_manager::to_string(pie::dbus::object_manager::Methods::GetManagedObject),
+                          to_route_handler(data, on_message_obj_mng_get_mng_objs));
     }
 
     LEAdvertisement::~LEAdvertisement() {
+        data->dbus->router().remove(data->path);
         pie::logger::log_if_debug(data->logger, LogLevel::Trace, "LEAdvertisement::~LEAdvertisement()");
     }
 
@@ -222,15 +248,12 @@ namespace pie::bluez {
     DBusHandlerResult LEAdvertisement::on_message(const dbus::DBusMessageInfo &msg_info,
                                                   std::shared_ptr<DBusMessage> message) {
         try {
-            if (msg_info.path == data->path) {
-                auto result = on_message_properties_get_all(msg_info, message, data);
-                if (result != DBUS_HANDLER_RESULT_NOT_YET_HANDLED)
-                    return result;
-
-                result = on_message_obj_mng_get_mng_objs(msg_info, message, data);
-                if (result != DBUS_HANDLER_RESULT_NOT_YET_HANDLED)
-                    return result;
-            }
+            if (pie::dbus::properties::is_method(msg_info, data->path, pie::dbus::properties::Methods::GetAll))
+                return on_message_properties_get_all(msg_info, message, data);
+
+            if (pie::dbus::object_manager::is_method(msg_info, data->path,
+                                                     pie::dbus::object_manager::Methods::GetManagedObject))
+                return on_message_obj_mng_get_mng_objs(msg_info, message, data);
         } catch (const std::exception &e) {
             std::stringstream ss;
             ss << "onmessage error: " << e.what();
@@ -9,12 +9,13 @@
 #include "pie/logging/console_helpers.h"
 #include "helper/bluez.h"
 #include "helper/le_advertising_manager.h"
+#include "pie/metrics/Registry.h"
 
 #include <utility>
 #include <vector>
 
 namespace {
-    const inline std::string TAG = "LEAdvertisingManager";
+    inline const pie::logging::LogTag &TAG = pie::logging::register_tag("LEAdvertisingManager");
 }
 
 namespace pie::bluez {
@@ -24,7 +25,6 @@ namespace pie::bluez {
         std::string path;
         std::shared_ptr<Logger> logger{nullptr};
         std::shared_ptr<dbus::DBus> dbus{nullptr};
-        std::shared_ptr<bluez::LEAdvertisingManager> self{nullptr};
         std::vector<std::shared_ptr<LEAdvertisement> > advertisements{};
     };
 
@@ -34,10 +34,7 @@ namespace pie::bluez {
         data->path = std::move(path);
         data->logger = std::move(logger);
         data->dbus = std::move(dbus);
-        std::shared_ptr<LEAdvertisingManager> self(this, [](LEAdvertisingManager *) {
-        });
-        data->dbus->subscribe(self);
-        data->self = std::move(self);
+        // advertisements register their own routes on DBus router
     }
 
     LEAdvertisingManager::~LEAdvertisingManager() {
@@ -45,7 +42,6 @@ namespace pie::bluez {
             unregister_advertisement(item);
 
         data->advertisements.clear();
-        data->self.reset();
         pie::logger::log_if_debug(data->logger, LogLevel::Trace, "LEAdvertisingManager::~LEAdvertisingManager()");
     }
 
@@ -58,6 +54,9 @@ namespace pie::bluez {
         advertisement->register_advertisement(msg);
         auto is_success = true;
         auto result =  data->dbus->send(std::move(msg));
+        pie::metrics::counter("le_advertisement_registrations_total",
+                              result.code == dbus::DBusResultCode::Success ? "result=\"success\"" : "result=\"error\"",
+                              "RegisterAdvertisement calls by result").add();
         if (result.code != dbus::DBusResultCode::Success) {
             std::stringstream ss;
             ss << "Failed RegisterAdvertisement: " << result.error;
@@ -5,14 +5,31 @@
 */
 
 #include "Characteristic.h"
+#include "NotifyCoalescer.h"
 #include "Service.h"
 #include "helper/characteristic.h"
 #include "pie/dbus/helper/dbus.h"
+#include "pie/io/SeqPacketReader.h"
+#include "pie/io/SeqPacketWriter.h"
 
 #include <pie/logging/console_helpers.h>
+#include <pie/logging/log.h>
+#include <pie/metrics/Registry.h>
+#include <pie/trace/Probe.h>
 
 #include "helper/service.h"
 
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+#include <optional>
+
 namespace pie::bluez::gatt {
     struct CharacteristicData {
         std::string uuid{};
@@ -22,14 +39,568 @@ namespace pie::bluez::gatt {
         std::shared_ptr<pie::dbus::DBus> dbus;
         std::shared_ptr<pie::Logger> logger;
         std::vector<std::string> flags{};
-        std::vector<uint8_t> value{};
+        // last written or set value served by ReadValue, references its WriteValue message or packet buffer
+        std::mutex value_mutex{};
+        pie::dbus::ByteView value{};
         std::weak_ptr<OnValueChanged> subscriber;
+        pie::metrics::Counter *writes{nullptr};
+        pie::metrics::Counter *written_bytes{nullptr};
+        // read characteristic offers ReadValue
+        bool can_read{false};
+        pie::metrics::Counter *reads{nullptr};
+        // write-without-response characteristic offers AcquireWrite
+        bool acquire_write{false};
+        // sockets handed out by AcquireWrite and still open
+        size_t write_links{0};
+        pie::metrics::Counter *acquired_packets{nullptr};
+        pie::metrics::Counter *acquired_bytes{nullptr};
+        // notify characteristic offers AcquireNotify, StartNotify and StopNotify
+        bool can_notify{false};
+        // socket acquired by AcquireNotify, set and reset on DBus thread, used by producers
+        std::mutex notify_mutex{};
+        std::shared_ptr<pie::io::SeqPacketWriter> notify_writer{};
+        // notify socket is polled for free space, used only by DBus thread
+        bool notify_blocked{false};
+        uint64_t notify_sent{0};
+        pie::metrics::Counter *notify_packets{nullptr};
+        pie::metrics::Counter *notify_overflows{nullptr};
+        // PropertiesChanged notifications between StartNotify and StopNotify
+        std::atomic<bool> notifying{false};
+        std::shared_ptr<NotifyCoalescer> coalescer{};
+        // coalescer timer is polled by DBus thread, set on first StartNotify
+        bool coalescer_polled{false};
+        // value of PropertiesChanged being sent, used only by DBus thread
+        std::vector<uint8_t> signal_value{};
+        pie::metrics::Counter *notify_signals{nullptr};
+        pie::metrics::Counter *notify_coalesced{nullptr};
     };
 }
 
 namespace {
     int id{0};
-    inline const std::string TAG{"gatt::Characteristic"};
+    inline const pie::logging::LogTag &TAG = pie::logging::register_tag("gatt::Characteristic");
+
+    // packets read from AcquireWrite or sent to AcquireNotify socket per event loop wakeup
+    constexpr size_t max_packets_per_wakeup{64};
+
+    // notifications queued for AcquireNotify socket
+    constexpr size_t notify_queue_capacity{256};
+
+    DBusHandlerResult reply(const std::shared_ptr<pie::bluez::gatt::CharacteristicData> &data,
+                            std::shared_ptr<DBusMessage> &&reply_msg) {
+        static const auto &format = pie::logging::register_format(TAG, "reply error: {}");
+        auto result = data->dbus->reply(std::move(reply_msg));
+        if (result.code != pie::dbus::DBusResultCode::Success)
+            pie::logger::log_format<pie::LogLevel::Warning>(data->logger, format, result.error);
+
+        return DBUS_HANDLER_RESULT_HANDLED;
+    }
+
+    DBusHandlerResult reply_error(const std::shared_ptr<pie::bluez::gatt::CharacteristicData> &data,
+                                  const std::shared_ptr<DBusMessage> &message,
+                                  const char *name,
+                                  const std::string &error) {
+        auto error_p = dbus_message_new_error(message.get(), name, error.c_str());
+        if (!error_p)
+            return DBUS_HANDLER_RESULT_NEED_MEMORY;
+
+        std::shared_ptr<DBusMessage> error_msg(error_p, [](DBusMessage *msg) {
+            dbus_message_unref(msg);
+        });
+        return reply(data, std::move(error_msg));
+    }
+
+    DBusHandlerResult on_message_write_value(
+        // read only by PIE_PROBE, which compiles to nothing without USDT
+        [[maybe_unused]] const pie::dbus::DBusMessageInfo &msg_info,
+        const std::shared_ptr<DBusMessage> &message,
+        const std::shared_ptr<pie::bluez::gatt::CharacteristicData> &data) {
+        pie::logger::log_lazy<pie::LogLevel::Trace>(data->logger, TAG, [](std::ostream &os) {
+            os << "on_message: Characteristic_WriteValue";
+        });
+
+        DBusMessageIter iter{nullptr};
+        dbus_message_iter_init(message.get(), &iter);
+        auto value = pie::dbus::message_get_byte_view(message.get(), &iter);
+        {
+            std::lock_guard<std::mutex> locker(data->value_mutex);
+            data->value = value;
+        }
+
+        data->writes->add();
+        data->written_bytes->add(value.size());
+        PIE_PROBE(gatt_write_value, data->path.c_str(), msg_info.serial, static_cast<uint64_t>(value.size()));
+
+        if (auto subscriber = data->subscriber.lock())
+            subscriber->on_value_changed(data->path, value);
+
+        dbus_message_iter_init_closed(&iter);
+
+        // without reply the call of bluetoothd ends with timeout error, write requests are answered late
+        if (dbus_message_get_no_reply(message.get()))
+            return DBUS_HANDLER_RESULT_HANDLED;
+
+        auto [success, reply_msg] = pie::dbus::message_new_method_return(data->logger, message);
+        if (!success)
+            return DBUS_HANDLER_RESULT_NEED_MEMORY;
+
+        return reply(data, std::move(reply_msg));
+    }
+
+    /**
+     * uint16 entry (e.g. "mtu", "offset") of a{sv} options of ReadValue, AcquireWrite or AcquireNotify.
+     * Options come from any bus client, every type is checked before it is read.
+     * @return default_value if entry is missing, nullopt if options are not a{sv} or entry is not uint16
+     */
+    std::optional<uint16_t> get_option_uint16(DBusMessageIter *iter, const char *name, uint16_t default_value) {
+        if (dbus_message_iter_get_arg_type(iter) != DBUS_TYPE_ARRAY ||
+            dbus_message_iter_get_element_type(iter) != DBUS_TYPE_DICT_ENTRY)
+            return std::nullopt;
+
+        DBusMessageIter arr_iter{nullptr};
+        for (dbus_message_iter_recurse(iter, &arr_iter);
+             dbus_message_iter_get_arg_type(&arr_iter) == DBUS_TYPE_DICT_ENTRY;
+             dbus_message_iter_next(&arr_iter)) {
+            DBusMessageIter entry_iter{nullptr};
+            dbus_message_iter_recurse(&arr_iter, &entry_iter);
+            if (dbus_message_iter_get_arg_type(&entry_iter) != DBUS_TYPE_STRING)
+                return std::nullopt;
+
+            const char *key{nullptr};
+            dbus_message_iter_get_basic(&entry_iter, &key);
+            dbus_message_iter_next(&entry_iter);
+            if (dbus_message_iter_get_arg_type(&entry_iter) != DBUS_TYPE_VARIANT)
+                return std::nullopt;
+
+            if (std::strcmp(key, name) != 0)
+                continue;
+
+            DBusMessageIter var_iter{nullptr};
+            dbus_message_iter_recurse(&entry_iter, &var_iter);
+            if (dbus_message_iter_get_arg_type(&var_iter) != DBUS_TYPE_UINT16)
+                return std::nullopt;
+
+            uint16_t value{0};
+            dbus_message_iter_get_basic(&var_iter, &value);
+            return value;
+        }
+
+        return default_value;
+    }
+
+    DBusHandlerResult reply_invalid_options(const std::shared_ptr<pie::bluez::gatt::CharacteristicData> &data,
+                                            const std::shared_ptr<DBusMessage> &message) {
+        return reply_error(data, message, pie::bluez::gatt::characteristic::error_invalid_arguments,
+                           "Expected a{sv} options with uint16 \"offset\" and \"mtu\"");
+    }
+
+    /**
+     * ReadValue(a{sv} options) -> ay. Reply is appended straight from cached value, from "offset",
+     * at most "mtu" - 1 bytes (ATT read response), bluetoothd reads the rest with next offset.
+     */
+    DBusHandlerResult on_message_read_value(
+        const std::shared_ptr<DBusMessage> &message,
+        const std::shared_ptr<pie::bluez::gatt::CharacteristicData> &data) {
+        pie::logger::log_lazy<pie::LogLevel::Trace>(data->logger, TAG, [](std::ostream &os) {
+            os << "on_message: Characteristic_ReadValue";
+        });
+
+        DBusMessageIter iter{nullptr};
+        dbus_message_iter_init(message.get(), &iter);
+        auto offset_option = get_option_uint16(&iter, "offset", 0);
+        auto mtu_option = get_option_uint16(&iter, "mtu", 0);
+        if (!offset_option || !mtu_option)
+            return reply_invalid_options(data, message);
+
+        size_t offset = *offset_option;
+        size_t mtu = *mtu_option;
+
+        pie::dbus::ByteView value{};
+        {
+            std::lock_guard<std::mutex> locker(data->value_mutex);
+            value = data->value;
+        }
+
+        if (offset > value.size())
+            return reply_error(data, message, pie::bluez::gatt::characteristic::error_invalid_offset,
+                               "Offset " + std::to_string(offset) + " over value length " +
+                               std::to_string(value.size()));
+
+        auto size = value.size() - offset;
+        if (mtu != 0)
+            size = std::min(size, std::max<size_t>(mtu, pie::bluez::gatt::characteristic::default_mtu) -
+                                  pie::bluez::gatt::characteristic::read_header_size);
+
+        auto [success, reply_msg] = pie::dbus::message_new_method_return(data->logger, message);
+        if (!success)
+            return DBUS_HANDLER_RESULT_NEED_MEMORY;
+
+        DBusMessageIter reply_iter{nullptr};
+        dbus_message_iter_init_append(reply_msg.get(), &reply_iter);
+        if (!pie::dbus::message_append_bytes(&reply_iter, value.data() + offset, size))
+            return DBUS_HANDLER_RESULT_NEED_MEMORY;
+
+        data->reads->add();
+        return reply(data, std::move(reply_msg));
+    }
+
+    /**
+     * Packets of AcquireWrite socket take the same path as WriteValue value
+     * @return false once bluetoothd closed the socket
+     */
+    bool on_acquired_write_readable(const std::shared_ptr<pie::bluez::gatt::CharacteristicData> &data,
+                                    pie::io::SeqPacketReader &reader) {
+        auto open = reader.read([&data](const pie::dbus::ByteView &packet) {
+            {
+                std::lock_guard<std::mutex> locker(data->value_mutex);
+                data->value = packet;
+            }
+
+            data->acquired_packets->add();
+            data->acquired_bytes->add(packet.size());
+            PIE_PROBE(gatt_acquired_write, data->path.c_str(), static_cast<uint64_t>(packet.size()));
+
+            if (auto subscriber = data->subscriber.lock())
+                subscriber->on_value_changed(data->path, packet);
+        }, max_packets_per_wakeup);
+
+        if (!open) {
+            --data->write_links;
+            pie::logger::log(data->logger, TAG, pie::LogLevel::Information,
+                             "AcquireWrite socket closed: " + data->path);
+        }
+
+        return open;
+    }
+
+    /**
+     * AcquireWrite(a{sv} options) -> (h fd, q mtu). bluetoothd writes every write command
+     * to returned end of seqpacket socket pair, the other end is read on DBus thread.
+     */
+    DBusHandlerResult on_message_acquire_write(
+        const std::shared_ptr<DBusMessage> &message,
+        const std::shared_ptr<pie::bluez::gatt::CharacteristicData> &data) {
+        pie::logger::log_lazy<pie::LogLevel::Trace>(data->logger, TAG, [](std::ostream &os) {
+            os << "on_message: Characteristic_AcquireWrite";
+        });
+
+        DBusMessageIter iter{nullptr};
+        dbus_message_iter_init(message.get(), &iter);
+        auto mtu_option = get_option_uint16(&iter, "mtu", pie::bluez::gatt::characteristic::default_mtu);
+        if (!mtu_option)
+            return reply_invalid_options(data, message);
+
+        auto mtu = std::max(*mtu_option, pie::bluez::gatt::characteristic::default_mtu);
+
+        int fds[2]{-1, -1};
+        if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, fds) != 0)
+            return reply_error(data, message, pie::bluez::gatt::characteristic::error_failed,
+                               std::string("socketpair failed: ") + strerror(errno));
+
+        auto reader = std::make_shared<pie::io::SeqPacketReader>(fds[0], mtu);
+        auto [success, reply_msg] = pie::dbus::message_new_method_return(data->logger, message);
+        // fd is duplicated by libdbus
+        auto appended = success && dbus_message_append_args(reply_msg.get(),
+                                                            DBUS_TYPE_UNIX_FD, &fds[1],
+                                                            DBUS_TYPE_UINT16, &mtu,
+                                                            DBUS_TYPE_INVALID);
+        close(fds[1]);
+        if (!appended)
+            return DBUS_HANDLER_RESULT_NEED_MEMORY;
+
+        std::weak_ptr<pie::bluez::gatt::CharacteristicData> weak_data = data;
+        auto result = data->dbus->add_reader(reader->fd(), [weak_data, reader]() {
+            auto data = weak_data.lock();
+            if (!data)
+                return false;
+
+            return on_acquired_write_readable(data, *reader);
+        });
+        if (result.code != pie::dbus::DBusResultCode::Success)
+            return reply_error(data, message, pie::bluez::gatt::characteristic::error_failed, result.error);
+
+        ++data->write_links;
+        std::stringstream ss{};
+        ss << "AcquireWrite: " << data->path << ", mtu: " << mtu;
+        pie::logger::log(data->logger, TAG, pie::LogLevel::Information, ss.str());
+        return reply(data, std::move(reply_msg));
+    }
+
+    /**
+     * Drop notify writer and remove both of its fds from DBus loop, fd callbacks calling it must return true
+     */
+    void release_notify(const std::shared_ptr<pie::bluez::gatt::CharacteristicData> &data,
+                        const std::shared_ptr<pie::io::SeqPacketWriter> &writer) {
+        {
+            std::lock_guard<std::mutex> locker(data->notify_mutex);
+            if (data->notify_writer == writer)
+                data->notify_writer.reset();
+        }
+
+        data->dbus->remove_fd(writer->wakeup_fd());
+        data->dbus->remove_fd(writer->fd());
+        pie::logger::log(data->logger, TAG, pie::LogLevel::Information,
+                         "AcquireNotify socket closed: " + data->path);
+    }
+
+    /**
+     * Send queued notifications, poll socket for free space while it is full, release writer once socket is closed
+     */
+    void flush_notify(const std::shared_ptr<pie::bluez::gatt::CharacteristicData> &data,
+                      const std::shared_ptr<pie::io::SeqPacketWriter> &writer) {
+        auto result = writer->flush(max_packets_per_wakeup);
+        auto sent = writer->sent();
+        data->notify_packets->add(sent - data->notify_sent);
+        data->notify_sent = sent;
+        if (result == pie::io::FlushResult::Closed) {
+            release_notify(data, writer);
+            return;
+        }
+
+        auto blocked = result == pie::io::FlushResult::Blocked;
+        if (blocked != data->notify_blocked) {
+            data->notify_blocked = blocked;
+            data->dbus->modify_fd(writer->fd(), blocked ? EPOLLIN | EPOLLOUT : EPOLLIN);
+        }
+    }
+
+    /**
+     * bluetoothd never writes to notify socket, readable socket means it was closed
+     */
+    bool is_closed(int fd, uint32_t events) {
+        if (events & (EPOLLHUP | EPOLLERR))
+            return true;
+
+        if (!(events & EPOLLIN))
+            return false;
+
+        uint8_t byte{0};
+        auto cnt = recv(fd, &byte, sizeof(byte), MSG_DONTWAIT);
+        return cnt == 0 || (cnt < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR);
+    }
+
+    /**
+     * AcquireNotify(a{sv} options) -> (h fd, q mtu). Notifications are written to the kept end of
+     * seqpacket socket pair, bluetoothd reads the returned end and notifies the central.
+     */
+    DBusHandlerResult on_message_acquire_notify(
+        const std::shared_ptr<DBusMessage> &message,
+        const std::shared_ptr<pie::bluez::gatt::CharacteristicData> &data) {
+        pie::logger::log_lazy<pie::LogLevel::Trace>(data->logger, TAG, [](std::ostream &os) {
+            os << "on_message: Characteristic_AcquireNotify";
+        });
+
+        {
+            std::lock_guard<std::mutex> locker(data->notify_mutex);
+            if (data->notify_writer)
+                return reply_error(data, message, pie::bluez::gatt::characteristic::error_failed,
+                                   "Notify already acquired");
+        }
+
+        DBusMessageIter iter{nullptr};
+        dbus_message_iter_init(message.get(), &iter);
+        auto mtu_option = get_option_uint16(&iter, "mtu", pie::bluez::gatt::characteristic::default_mtu);
+        if (!mtu_option)
+            return reply_invalid_options(data, message);
+
+        auto mtu = std::max(*mtu_option, pie::bluez::gatt::characteristic::default_mtu);
+
+        int fds[2]{-1, -1};
+        if (socketpair(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0, fds) != 0)
+            return reply_error(data, message, pie::bluez::gatt::characteristic::error_failed,
+                               std::string("socketpair failed: ") + strerror(errno));
+
+        std::shared_ptr<pie::io::SeqPacketWriter> writer{};
+        try {
+            writer = std::make_shared<pie::io::SeqPacketWriter>(
+                fds[0], mtu - pie::bluez::gatt::characteristic::notify_header_size, notify_queue_capacity);
+        } catch (const std::exception &e) {
+            close(fds[1]);
+            return reply_error(data, message, pie::bluez::gatt::characteristic::error_failed, e.what());
+        }
+
+        auto [success, reply_msg] = pie::dbus::message_new_method_return(data->logger, message);
+        // fd is duplicated by libdbus
+        auto appended = success && dbus_message_append_args(reply_msg.get(),
+                                                            DBUS_TYPE_UNIX_FD, &fds[1],
+                                                            DBUS_TYPE_UINT16, &mtu,
+                                                            DBUS_TYPE_INVALID);
+        close(fds[1]);
+        if (!appended)
+            return DBUS_HANDLER_RESULT_NEED_MEMORY;
+
+        std::weak_ptr<pie::bluez::gatt::CharacteristicData> weak_data = data;
+        auto result = data->dbus->add_reader(writer->wakeup_fd(), [weak_data, writer]() {
+            auto data = weak_data.lock();
+            if (!data)
+                return false;
+
+            flush_notify(data, writer);
+            return true;
+        });
+        if (result.code == pie::dbus::DBusResultCode::Success) {
+            result = data->dbus->add_fd(writer->fd(), EPOLLIN, [weak_data, writer](uint32_t events) {
+                auto data = weak_data.lock();
+                if (!data)
+                    return false;
+
+                if (is_closed(writer->fd(), events))
+                    release_notify(data, writer);
+                else if (events & EPOLLOUT)
+                    flush_notify(data, writer);
+
+                return true;
+            });
+            if (result.code != pie::dbus::DBusResultCode::Success)
+                data->dbus->remove_fd(writer->wakeup_fd());
+        }
+
+        if (result.code != pie::dbus::DBusResultCode::Success)
+            return reply_error(data, message, pie::bluez::gatt::characteristic::error_failed, result.error);
+
+        {
+            std::lock_guard<std::mutex> locker(data->notify_mutex);
+            data->notify_writer = writer;
+        }
+
+        data->notify_blocked = false;
+        data->notify_sent = 0;
+        std::stringstream ss{};
+        ss << "AcquireNotify: " << data->path << ", mtu: " << mtu;
+        pie::logger::log(data->logger, TAG, pie::LogLevel::Information, ss.str());
+        return reply(data, std::move(reply_msg));
+    }
+
+    /**
+     * PropertiesChanged(s iface, a{sv} changed, as invalidated) with "Value"
+     */
+    void emit_value_changed(const std::shared_ptr<pie::bluez::gatt::CharacteristicData> &data) {
+        if (!data->coalescer->take(data->signal_value) || !data->notifying)
+            return;
+
+        auto signal = pie::dbus::properties::message_new_signal(
+            data->path, pie::dbus::properties::Signals::PropertiesChanged);
+        if (!signal)
+            return;
+
+        DBusMessageIter iter{nullptr};
+        dbus_message_iter_init_append(signal.get(), &iter);
+        auto iface = data->iface.c_str();
+        dbus_message_iter_append_basic(&iter, DBUS_TYPE_STRING, &iface);
+        DBusMessageIter arr_iter{nullptr};
+        dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY, "{sv}", &arr_iter);
+        pie::dbus::message_append_dict_entry(
+            &arr_iter,
+            pie::bluez::gatt::characteristic::to_string(pie::bluez::gatt::characteristic::Property::Value),
+            data->signal_value);
+        dbus_message_iter_close_container(&iter, &arr_iter);
+        dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY, DBUS_TYPE_STRING_AS_STRING, &arr_iter);
+        dbus_message_iter_close_container(&iter, &arr_iter);
+
+        // reply sends any message on DBus thread, flushed by execute loop
+        auto result = data->dbus->reply(std::move(signal));
+        if (result.code != pie::dbus::DBusResultCode::Success) {
+            pie::logger::log(data->logger, TAG, pie::LogLevel::Warning, "PropertiesChanged error: " + result.error);
+            return;
+        }
+
+        data->notify_signals->add();
+    }
+
+    DBusHandlerResult on_message_start_notify(
+        const std::shared_ptr<DBusMessage> &message,
+        const std::shared_ptr<pie::bluez::gatt::CharacteristicData> &data) {
+        pie::logger::log_lazy<pie::LogLevel::Trace>(data->logger, TAG, [](std::ostream &os) {
+            os << "on_message: Characteristic_StartNotify";
+        });
+
+        if (!data->coalescer_polled) {
+            // reader owns coalescer so its fd stays open until ~Characteristic shutdown lets the reader remove it
+            std::weak_ptr<pie::bluez::gatt::CharacteristicData> weak_data = data;
+            auto result = data->dbus->add_reader(data->coalescer->fd(), [weak_data, coalescer = data->coalescer]() {
+                auto data = weak_data.lock();
+                if (!data || coalescer->is_shut_down())
+                    return false;
+
+                emit_value_changed(data);
+                return true;
+            });
+            if (result.code != pie::dbus::DBusResultCode::Success)
+                return reply_error(data, message, pie::bluez::gatt::characteristic::error_failed, result.error);
+
+            data->coalescer_polled = true;
+        }
+
+        data->notifying = true;
+        auto [success, reply_msg] = pie::dbus::message_new_method_return(data->logger, message);
+        if (!success)
+            return DBUS_HANDLER_RESULT_NEED_MEMORY;
+
+        return reply(data, std::move(reply_msg));
+    }
+
+    DBusHandlerResult on_message_stop_notify(
+        const std::shared_ptr<DBusMessage> &message,
+        const std::shared_ptr<pie::bluez::gatt::CharacteristicData> &data) {
+        pie::logger::log_lazy<pie::LogLevel::Trace>(data->logger, TAG, [](std::ostream &os) {
+            os << "on_message: Characteristic_StopNotify";
+        });
+
+        data->notifying = false;
+        data->coalescer->clear();
+        auto [success, reply_msg] = pie::dbus::message_new_method_return(data->logger, message);
+        if (!success)
+            return DBUS_HANDLER_RESULT_NEED_MEMORY;
+
+        return reply(data, std::move(reply_msg));
+    }
+
+    using MethodHandler = DBusHandlerResult (*)(const std::shared_ptr<DBusMessage> &message,
+                                                 const std::shared_ptr<pie::bluez::gatt::CharacteristicData> &data);
+
+    using MethodInfoHandler = DBusHandlerResult (*)(const pie::dbus::DBusMessageInfo &msg_info,
+                                                     const std::shared_ptr<DBusMessage> &message,
+                                                     const std::shared_ptr<pie::bluez::gatt::CharacteristicData> &data);
+
+    template<typename Handler>
+    void route_method(const std::shared_ptr<pie::bluez::gatt::CharacteristicData> &data,
+                      pie::bluez::gatt::characteristic::Methods method,
+                      Handler handler) {
+        std::weak_ptr<pie::bluez::gatt::CharacteristicData> weak_data = data;
+        data->dbus->router().add_method(
+            data->path, data->iface, pie::bluez::gatt::characteristic::to_string(method),
+            [weak_data, handler](const pie::dbus::DBusMessageInfo &msg_info, std::shared_ptr<DBusMessage> message) {
+                auto data = weak_data.lock();
+                if (!data)
+                    return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+
+                try {
+                    return handler(msg_info, message, data);
+                } catch (const std::exception &e) {
+                    std::stringstream ss;
+                    ss << "on_message error: " << e.what();
+                    pie::logger::log(data->logger, TAG, pie::LogLevel::Warning, ss.str());
+                }
+
+                return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+            });
+    }
+
+    void add_method(const std::shared_ptr<pie::bluez::gatt::CharacteristicData> &data,
+                    pie::bluez::gatt::characteristic::Methods method,
+                    MethodInfoHandler handler) {
+        route_method(data, method, handler);
+    }
+
+    void add_method(const std::shared_ptr<pie::bluez::gatt::CharacteristicData> &data,
+                    pie::bluez::gatt::characteristic::Methods method,
+                    MethodHandler handler) {
+        route_method(data, method, [handler](const pie::dbus::DBusMessageInfo &,
+                                             const std::shared_ptr<DBusMessage> &message,
+                                             const std::shared_ptr<pie::bluez::gatt::CharacteristicData> &data) {
+            return handler(message, data);
+        });
+    }
 }
 
 namespace pie::bluez::gatt {
@@ -45,6 +616,10 @@ namespace pie::bluez::gatt {
         data->dbus = dbus;
         data->logger = logger;
         data->uuid = uuid;
+        auto labels = "uuid=\"" + uuid + "\"";
+        data->writes = &pie::metrics::counter("gatt_write_value_total", labels, "WriteValue calls by characteristic");
+        data->written_bytes = &pie::metrics::counter("gatt_write_value_bytes_total", labels,
+                                                     "Bytes written by WriteValue by characteristic");
         std::stringstream ss{};
         if (auto p_service = data->service.lock())
             ss << p_service->path() << "/characteristic" << id++;
@@ -56,9 +631,47 @@ namespace pie::bluez::gatt {
             flags_as_strings.emplace_back(pie::bluez::gatt::characteristic::to_string(flag));
 
         data->flags = flags_as_strings;
+        data->can_read = std::find(flags.begin(), flags.end(), characteristic::Flag::Read) != flags.end();
+        data->reads = &pie::metrics::counter("gatt_read_value_total", labels, "ReadValue calls by characteristic");
+        data->acquire_write = std::find(flags.begin(), flags.end(),
+                                        characteristic::Flag::WriteWithoutResponse) != flags.end();
+        data->acquired_packets = &pie::metrics::counter("gatt_acquired_write_packets_total", labels,
+                                                        "Packets read from AcquireWrite sockets by characteristic");
+        data->acquired_bytes = &pie::metrics::counter("gatt_acquired_write_bytes_total", labels,
+                                                      "Bytes read from AcquireWrite sockets by characteristic");
+        data->can_notify = std::find(flags.begin(), flags.end(),
+                                         characteristic::Flag::Notify) != flags.end();
+        data->notify_packets = &pie::metrics::counter("gatt_acquired_notify_packets_total", labels,
+                                                      "Notifications sent to AcquireNotify socket by characteristic");
+        data->notify_overflows = &pie::metrics::counter("gatt_notify_overflows_total", labels,
+                                                        "Notifications rejected by full queue by characteristic");
+        data->notify_signals = &pie::metrics::counter("gatt_notify_signals_total", labels,
+                                                      "PropertiesChanged notifications sent by characteristic");
+        data->notify_coalesced = &pie::metrics::counter(
+            "gatt_notify_coalesced_total", labels,
+            "Notifications replaced by newer value before PropertiesChanged by characteristic");
+
+        add_method(data, characteristic::Methods::WriteValue, on_message_write_value);
+
+        if (data->can_read)
+            add_method(data, characteristic::Methods::ReadValue, on_message_read_value);
+
+        if (data->acquire_write)
+            add_method(data, characteristic::Methods::AcquireWrite, on_message_acquire_write);
+
+        if (data->can_notify) {
+            data->coalescer = std::make_shared<NotifyCoalescer>(characteristic::default_notify_interval);
+            add_method(data, characteristic::Methods::AcquireNotify, on_message_acquire_notify);
+            add_method(data, characteristic::Methods::StartNotify, on_message_start_notify);
+            add_method(data, characteristic::Methods::StopNotify, on_message_stop_notify);
+        }
     }
 
     Characteristic::~Characteristic() {
+        data->dbus->router().remove(data->path);
+        if (data->coalescer)
+            data->coalescer->shutdown();
+
         std::stringstream ss;
         ss << "Characteristic::~Characteristic()[";
         ss << "uuid: " << data->uuid;
@@ -74,6 +687,56 @@ namespace pie::bluez::gatt {
         return data->uuid;
     }
 
+    NotifyResult Characteristic::notify(const uint8_t *value, size_t size) {
+        std::shared_ptr<pie::io::SeqPacketWriter> writer{};
+        {
+            std::lock_guard<std::mutex> locker(data->notify_mutex);
+            writer = data->notify_writer;
+        }
+
+        if (!writer) {
+            if (!data->notifying)
+                return NotifyResult::NotSubscribed;
+
+            if (size > characteristic::max_value_size)
+                return NotifyResult::TooLarge;
+
+            if (data->coalescer->push(value, size))
+                data->notify_coalesced->add();
+
+            return NotifyResult::Queued;
+        }
+
+        switch (writer->push(value, size)) {
+            case pie::io::PushResult::Queued:
+                return NotifyResult::Queued;
+            case pie::io::PushResult::Full:
+                data->notify_overflows->add();
+                return NotifyResult::Full;
+            case pie::io::PushResult::TooLarge:
+                return NotifyResult::TooLarge;
+        }
+
+        return NotifyResult::NotSubscribed;
+    }
+
+    void Characteristic::value(const uint8_t *value, size_t size) {
+        auto buffer = std::make_shared<std::vector<uint8_t> >(value, value + size);
+        pie::dbus::ByteView view{buffer, buffer->data(), buffer->size()};
+        std::lock_guard<std::mutex> locker(data->value_mutex);
+        data->value = std::move(view);
+    }
+
+    pie::dbus::ByteView Characteristic::value() const {
+        std::lock_guard<std::mutex> locker(data->value_mutex);
+        return data->value;
+    }
+
+    void Characteristic::notify_interval(std::chrono::microseconds interval) {
+        if (data->coalescer)
+            data->coalescer->interval(interval);
+    }
+
     void Characteristic::get_managed_objects(DBusMessageIter *iter) {
         // Characteristic entry: {oa{sa{sa}}}
         DBusMessageIter sub_iter;
@@ -121,6 +784,24 @@ namespace pie::bluez::gatt {
                 characteristic::Property::Flags),
             data->flags);
 
+        // presence of WriteAcquired makes bluetoothd call AcquireWrite instead of WriteValue
+        if (data->acquire_write)
+            pie::dbus::message_append_dict_entry(
+                &props_iter,
+                pie::bluez::gatt::characteristic::to_string(
+                    characteristic::Property::WriteAcquired),
+                data->write_links > 0);
+
+        // presence of NotifyAcquired makes bluetoothd call AcquireNotify instead of StartNotify
+        if (data->can_notify) {
+            std::lock_guard<std::mutex> locker(data->notify_mutex);
+            pie::dbus::message_append_dict_entry(
+                &props_iter,
+                pie::bluez::gatt::characteristic::to_string(
+                    characteristic::Property::NotifyAcquired),
+                data->notify_writer != nullptr);
+        }
+
         // Descriptor array of objects
         std::vector<std::string> descriptor_uuids{};
         // TODO add descriptors UUIDs to the list
@@ -143,20 +824,33 @@ namespace pie::bluez::gatt {
             return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
 
         if (pie::bluez::gatt::characteristic::is_method(msg_info, data->path,
-                                                        pie::bluez::gatt::characteristic::Methods::WriteValue)) {
-            pie::logger::log_if_debug(data->logger, TAG, LogLevel::Trace,
-                                      "on_message: Characteristic_WriteValue");
+                                                        pie::bluez::gatt::characteristic::Methods::WriteValue))
+            return on_message_write_value(msg_info, message, data);
 
-            DBusMessageIter iter{nullptr};
-            dbus_message_iter_init(message.get(), &iter);
-            data->value = pie::dbus::message_get_bytes(&iter);
+        if (data->can_read &&
+            pie::bluez::gatt::characteristic::is_method(msg_info, data->path,
+                                                        pie::bluez::gatt::characteristic::Methods::ReadValue))
+            return on_message_read_value(message, data);
 
-            if (auto subscriber = data->subscriber.lock())
-                subscriber->on_value_changed(data->path, data->value);
+        if (data->acquire_write &&
+            pie::bluez::gatt::characteristic::is_method(msg_info, data->path,
+                                                        pie::bluez::gatt::characteristic::Methods::AcquireWrite))
+            return on_message_acquire_write(message, data);
 
-            dbus_message_iter_init_closed(&iter);
-            return DBUS_HANDLER_RESULT_HANDLED;
-        }
+        if (data->can_notify &&
+            pie::bluez::gatt::characteristic::is_method(msg_info, data->path,
+                                                        pie::bluez::gatt::characteristic::Methods::AcquireNotify))
+            return on_message_acquire_notify(message, data);
+
+        if (data->can_notify &&
+            pie::bluez::gatt::characteristic::is_method(msg_info, data->path,
+                                                        pie::bluez::gatt::characteristic::Methods::StartNotify))
+            return on_message_start_notify(message, data);
+
+        if (data->can_notify &&
+            pie::bluez::gatt::characteristic::is_method(msg_info, data->path,
+                                                        pie::bluez::gatt::characteristic::Methods::StopNotify))
+            return on_message_stop_notify(message, data);
 
         return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
     }
@@ -18,6 +18,17 @@
 namespace pie::bluez::gatt {
     struct CharacteristicData;
 
+    enum class NotifyResult {
+        // queued for AcquireNotify socket or stored as pending PropertiesChanged value
+        Queued,
+        // nobody acquired or started notifications
+        NotSubscribed,
+        // notification queue is full, the central is slower than producer
+        Full,
+        // value does not fit negotiated MTU
+        TooLarge
+    };
+
     class Service;
 
     class Characteristic : public dbus::DBusObjectManager, dbus::DBusOnMessage {
@@ -35,6 +46,31 @@ namespace pie::bluez::gatt {
 
         [[nodiscard]] const std::string &uuid() const;
 
+        /**
+         * Set value served by ReadValue, until replaced by next write. Thread safe.
+         */
+        void value(const uint8_t *value, size_t size);
+
+        /**
+         * Last written or set value. Thread safe.
+         */
+        [[nodiscard]] pie::dbus::ByteView value() const;
+
+        /**
+         * Send notification to socket acquired by bluetoothd with AcquireNotify. Value is copied to
+         * per characteristic queue drained on DBus thread, many notifications per syscall.
+         * Without acquired socket, after StartNotify, value is emitted as PropertiesChanged of "Value",
+         * at most once per notify_interval, faster values are coalesced (latest wins).
+         * Thread safe, never blocks.
+         */
+        NotifyResult notify(const uint8_t *value, size_t size);
+
+        /**
+         * Min time between PropertiesChanged notifications, default characteristic::default_notify_interval.
+         * Thread safe.
+         */
+        void notify_interval(std::chrono::microseconds interval);
+
         void get_managed_objects(DBusMessageIter *iter) override;
 
         DBusHandlerResult on_message(
@@ -0,0 +1,111 @@
+/**
+* @file NotifyCoalescer.cpp
+* @author Ilija Poznic
+* @date 2025
+*/
+
+#include "NotifyCoalescer.h"
+
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <mutex>
+#include <system_error>
+
+namespace pie::bluez::gatt {
+    struct NotifyCoalescerData {
+        int fd{-1};
+        std::mutex mutex{};
+        std::chrono::steady_clock::duration interval{};
+        std::chrono::steady_clock::time_point last_release{};
+        std::vector<uint8_t> pending{};
+        bool has_pending{false};
+        bool armed{false};
+        bool shut_down{false};
+    };
+}
+
+namespace {
+    void arm(int fd, std::chrono::steady_clock::duration delay) {
+        // zero it_value disarms the timer
+        auto ns = std::max<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(delay).count(), 1);
+        itimerspec spec{};
+        spec.it_value.tv_sec = static_cast<time_t>(ns / 1000000000);
+        spec.it_value.tv_nsec = static_cast<long>(ns % 1000000000);
+        timerfd_settime(fd, 0, &spec, nullptr);
+    }
+}
+
+namespace pie::bluez::gatt {
+    NotifyCoalescer::NotifyCoalescer(std::chrono::microseconds interval) {
+        data = std::make_shared<NotifyCoalescerData>();
+        data->interval = interval;
+        data->fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if (data->fd < 0)
+            throw std::system_error(errno, std::generic_category(), "timerfd_create failed");
+    }
+
+    NotifyCoalescer::~NotifyCoalescer() {
+        close(data->fd);
+    }
+
+    int NotifyCoalescer::fd() const {
+        return data->fd;
+    }
+
+    void NotifyCoalescer::interval(std::chrono::microseconds interval) {
+        std::lock_guard<std::mutex> locker(data->mutex);
+        data->interval = interval;
+    }
+
+    bool NotifyCoalescer::push(const uint8_t *value, size_t size) {
+        std::lock_guard<std::mutex> locker(data->mutex);
+        if (data->shut_down)
+            return false;
+
+        auto replaced = data->has_pending;
+        data->pending.assign(value, value + size);
+        data->has_pending = true;
+        if (!data->armed) {
+            data->armed = true;
+            arm(data->fd, data->last_release + data->interval - std::chrono::steady_clock::now());
+        }
+
+        return replaced;
+    }
+
+    bool NotifyCoalescer::take(std::vector<uint8_t> &value) {
+        uint64_t expirations{0};
+        [[maybe_unused]] auto read_cnt = read(data->fd, &expirations, sizeof(expirations));
+
+        std::lock_guard<std::mutex> locker(data->mutex);
+        data->armed = false;
+        if (!data->has_pending)
+            return false;
+
+        value.swap(data->pending);
+        data->has_pending = false;
+        data->last_release = std::chrono::steady_clock::now();
+        return true;
+    }
+
+    void NotifyCoalescer::clear() {
+        std::lock_guard<std::mutex> locker(data->mutex);
+        data->has_pending = false;
+    }
+
+    void NotifyCoalescer::shutdown() {
+        std::lock_guard<std::mutex> locker(data->mutex);
+        data->shut_down = true;
+        data->has_pending = false;
+        data->armed = true;
+        arm(data->fd, std::chrono::steady_clock::duration::zero());
+    }
+
+    bool NotifyCoalescer::is_shut_down() const {
+        std::lock_guard<std::mutex> locker(data->mutex);
+        return data->shut_down;
+    }
+} // pie::bluez::gatt
@@ -0,0 +1,74 @@
+/**
+* @file NotifyCoalescer.h
+* @author Ilija Poznic
+* @date 2025
+*/
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace pie::bluez::gatt {
+    struct NotifyCoalescerData;
+
+    /**
+     * Latest value wins slot between notification producers and DBus thread, used for PropertiesChanged
+     * notifications. Values are released at most once per interval: push arms a timerfd for the time
+     * the next value is due, values pushed before it fires replace the pending one.
+     */
+    class NotifyCoalescer {
+    public:
+        /**
+         * @throw std::system_error if timerfd can not be created
+         */
+        explicit NotifyCoalescer(std::chrono::microseconds interval);
+
+        ~NotifyCoalescer();
+
+        NotifyCoalescer(const NotifyCoalescer &) = delete;
+
+        NotifyCoalescer &operator=(const NotifyCoalescer &) = delete;
+
+        /**
+         * timerfd, readable when pending value is due
+         */
+        [[nodiscard]] int fd() const;
+
+        /**
+         * Min time between released values, 0 releases every value on the next loop iteration. Thread safe.
+         */
+        void interval(std::chrono::microseconds interval);
+
+        /**
+         * Store value as pending. Thread safe.
+         * @return true if it replaced pending value not released yet
+         */
+        bool push(const uint8_t *value, size_t size);
+
+        /**
+         * Take due value once fd() is readable, value buffer is swapped with pending one to keep capacity
+         * @return false if nothing is pending (e.g. dropped by clear)
+         */
+        bool take(std::vector<uint8_t> &value);
+
+        /**
+         * Drop pending value. Thread safe.
+         */
+        void clear();
+
+        /**
+         * Drop pending value and make fd() readable right away, so its poller sees is_shut_down() and
+         * removes fd from its loop before coalescer is destroyed. Values pushed later are ignored. Thread safe.
+         */
+        void shutdown();
+
+        [[nodiscard]] bool is_shut_down() const;
+
+    private:
+        std::shared_ptr<NotifyCoalescerData> data;
+    };
+} // pie::bluez::gatt
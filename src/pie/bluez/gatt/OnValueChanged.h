@@ -6,7 +6,8 @@
 
 #pragma once
 
-#include <vector>
+#include "pie/dbus/ByteView.h"
+
 #include <string>
 
 namespace pie::bluez::gatt {
@@ -16,10 +17,10 @@ namespace pie::bluez::gatt {
 
         /**
          * @param uuid GATT
-         * @param value new value received
-         * @return value that will be sent back and cached
+         * @param value new value received, points into received message or AcquireWrite packet buffer.
+         * Copy the view to keep it alive or value.to_vector() to keep only the bytes.
          */
         virtual void on_value_changed(const std::string &uuid,
-                                      const std::vector<uint8_t> &value) = 0;
+                                      const pie::dbus::ByteView &value) = 0;
     };
 }
@@ -28,7 +28,7 @@ namespace pie::bluez::gatt {
 
 namespace {
     int id{0};
-    inline const std::string TAG{"gatt::Service"};
+    inline const pie::logging::LogTag &TAG = pie::logging::register_tag("gatt::Service");
 }
 
 namespace pie::bluez::gatt {
@@ -23,6 +23,10 @@ namespace pie::bluez::gatt::characteristic {
                 return "Descriptors";
             case Property::Value:
                 return "Value";
+            case Property::WriteAcquired:
+                return "WriteAcquired";
+            case Property::NotifyAcquired:
+                return "NotifyAcquired";
             default:
                 return "Unknown";
         }
@@ -47,21 +51,35 @@ namespace pie::bluez::gatt::characteristic {
         }
     }
 
-    std::string to_string(Methods method) {
-        switch (method) {
-            case Methods::ReadValue:
-                return "ReadValue";
-            case Methods::WriteValue:
-                return "WriteValue";
-            default:
-                return "Unknown";
+    namespace {
+        const char *member_name(Methods method) {
+            switch (method) {
+                case Methods::ReadValue:
+                    return "ReadValue";
+                case Methods::WriteValue:
+                    return "WriteValue";
+                case Methods::AcquireWrite:
+                    return "AcquireWrite";
+                case Methods::AcquireNotify:
+                    return "AcquireNotify";
+                case Methods::StartNotify:
+                    return "StartNotify";
+                case Methods::StopNotify:
+                    return "StopNotify";
+                default:
+                    return "Unknown";
+            }
         }
     }
 
+    std::string to_string(Methods method) {
+        return member_name(method);
+    }
+
     bool is_method(const pie::dbus::DBusMessageInfo &msg_info, const std::string &path, Methods method) {
         if (msg_info.iface == iface &&
             msg_info.path == path &&
-            msg_info.member == to_string(method))
+            msg_info.member == member_name(method))
             return true;
 
         return false;
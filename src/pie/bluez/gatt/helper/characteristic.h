@@ -11,6 +11,37 @@
 namespace pie::bluez::gatt::characteristic {
     inline const char *iface = "org.bluez.GattCharacteristic1";
 
+    inline const char *error_failed = "org.bluez.Error.Failed";
+
+    inline const char *error_invalid_offset = "org.bluez.Error.InvalidOffset";
+
+    inline const char *error_invalid_arguments = "org.bluez.Error.InvalidArguments";
+
+    /**
+     * ATT_MTU used when AcquireWrite or AcquireNotify options carry no "mtu"
+     */
+    inline constexpr uint16_t default_mtu{23};
+
+    /**
+     * Bytes of ATT_MTU taken by notification header (opcode and handle)
+     */
+    inline constexpr uint16_t notify_header_size{3};
+
+    /**
+     * Bytes of ATT_MTU taken by read response header (opcode)
+     */
+    inline constexpr uint16_t read_header_size{1};
+
+    /**
+     * Max length of attribute value
+     */
+    inline constexpr size_t max_value_size{512};
+
+    /**
+     * Min time between PropertiesChanged notifications of one characteristic, faster values are coalesced
+     */
+    inline constexpr std::chrono::microseconds default_notify_interval{10000};
+
     bool is_interface(const pie::dbus::DBusMessageInfo &msg_info);
 
     enum class Property {
@@ -19,6 +50,8 @@ namespace pie::bluez::gatt::characteristic {
         Flags,
         Descriptors,
         Value,
+        WriteAcquired,
+        NotifyAcquired,
         Unknown
     };
 
@@ -39,8 +72,14 @@ namespace pie::bluez::gatt::characteristic {
     enum class Methods {
         ReadValue,
         WriteValue,
+        AcquireWrite,
+        AcquireNotify,
+        StartNotify,
+        StopNotify,
         Unknown
     };
 
+    std::string to_string(Methods method);
+
     bool is_method(const pie::dbus::DBusMessageInfo &msg_info, const std::string &path, Methods method);
 } // pie
@@ -7,24 +7,30 @@
 #include "manager.h"
 
 namespace pie::bluez::gatt::manager {
-    std::string to_string(Methods method) {
-        switch (method) {
-            case Methods::RegisterApplication:
-                return "RegisterApplication";
-            case Methods::UnregisterApplication:
-                return "UnregisterApplication";
-            default:
-                return "Unknown";
+    namespace {
+        const char *member_name(Methods method) {
+            switch (method) {
+                case Methods::RegisterApplication:
+                    return "RegisterApplication";
+                case Methods::UnregisterApplication:
+                    return "UnregisterApplication";
+                default:
+                    return "Unknown";
+            }
         }
     }
 
+    std::string to_string(Methods method) {
+        return member_name(method);
+    }
+
     bool is_method(
         const dbus::DBusMessageInfo &msg_info,
         const std::string &path,
         Methods method) {
         if (msg_info.iface == iface &&
             msg_info.path == path &&
-            msg_info.member == to_string(method))
+            msg_info.member == member_name(method))
             return true;
 
         return false;
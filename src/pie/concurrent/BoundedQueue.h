@@ -0,0 +1,225 @@
+/**
+ * @file BoundedQueue.h
+ * @author Ilija Poznic
+ * @date 2025
+ */
+
+#pragma once
+
+#include "ConcurrentQueue.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+namespace pie::concurrent {
+    enum class OverflowPolicy {
+        // block producer until there is space or deadline expires
+        Block,
+        // fail immediately
+        Reject,
+        // accept new value, producer evicts oldest value when queue is full
+        DropOldest
+    };
+
+    enum class PushResult {
+        Success,
+        Rejected,
+        Timeout
+    };
+
+    /**
+     * Capacity limited multi-producer / single-consumer queue on top of ConcurrentQueue, depth never exceeds
+     * capacity. Producers only take mutex when they have to block (OverflowPolicy::Block and queue full)
+     * or evict (OverflowPolicy::DropOldest and queue full), with DropOldest consumer pops under the same mutex.
+     */
+    template<typename Value>
+    class BoundedQueue {
+    public:
+        /**
+         * @param capacity - max number of queued values, 0 means unbounded
+         * @param on_dropped - called with every value evicted by DropOldest, on the thread pushing the newer value
+         */
+        explicit BoundedQueue(size_t capacity, OverflowPolicy policy = OverflowPolicy::Block,
+                              std::function<void(Value &&value)> on_dropped = {})
+            : capacity_(capacity == 0 ? std::numeric_limits<size_t>::max() : capacity), policy_(policy),
+              on_dropped_(std::move(on_dropped)) {
+        }
+
+        PushResult push(Value value, std::chrono::steady_clock::time_point deadline) {
+            switch (policy_) {
+                case OverflowPolicy::DropOldest:
+                    while (!try_reserve())
+                        evict_oldest();
+                    break;
+                case OverflowPolicy::Reject:
+                    if (!try_reserve()) {
+                        rejected_.fetch_add(1, std::memory_order_relaxed);
+                        return PushResult::Rejected;
+                    }
+                    break;
+                case OverflowPolicy::Block:
+                    if (!try_reserve() && !wait_reserve(deadline)) {
+                        rejected_.fetch_add(1, std::memory_order_relaxed);
+                        return PushResult::Timeout;
+                    }
+                    break;
+            }
+
+            queue.push(std::move(value));
+            return PushResult::Success;
+        }
+
+        /**
+         * Consumer only. Pop up to max values.
+         * @param consumer - callable with Value&&
+         * @return number of values passed to consumer
+         */
+        template<typename Consumer>
+        size_t pop_all(Consumer &&consumer, size_t max = std::numeric_limits<size_t>::max()) {
+            size_t cnt{0};
+            while (cnt < max) {
+                auto value = try_pop();
+                if (!value)
+                    break;
+
+                consumer(std::move(*value));
+                ++cnt;
+            }
+
+            if (cnt > 0)
+                notify_space();
+
+            return cnt;
+        }
+
+        [[nodiscard]] bool empty() const {
+            return queue.empty();
+        }
+
+        [[nodiscard]] size_t capacity() const {
+            return capacity_;
+        }
+
+        [[nodiscard]] size_t depth() const {
+            return depth_.load(std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] size_t high_water_mark() const {
+            return high_water_mark_.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @return number of values not accepted (Reject policy) or not accepted before deadline (Block policy)
+         */
+        [[nodiscard]] uint64_t rejected() const {
+            return rejected_.load(std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] uint64_t dropped() const {
+            return dropped_.load(std::memory_order_relaxed);
+        }
+
+    private:
+        std::optional<Value> try_pop() {
+            std::optional<Value> value{};
+            if (policy_ == OverflowPolicy::DropOldest) {
+                // producers evicting pop from the same end
+                std::lock_guard<std::mutex> locker(mutex);
+                value = queue.try_pop();
+            } else {
+                value = queue.try_pop();
+            }
+
+            if (value)
+                depth_.fetch_sub(1, std::memory_order_release);
+            return value;
+        }
+
+        /**
+         * Free one slot for DropOldest push. Slots reserved by producers still in the middle of push
+         * can not be popped yet, then wait for them.
+         */
+        void evict_oldest() {
+            std::optional<Value> value{};
+            {
+                std::lock_guard<std::mutex> locker(mutex);
+                if (depth_.load(std::memory_order_acquire) < capacity_)
+                    return;
+
+                value = queue.try_pop();
+                if (value)
+                    depth_.fetch_sub(1, std::memory_order_release);
+            }
+
+            if (!value) {
+                std::this_thread::yield();
+                return;
+            }
+
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            if (on_dropped_)
+                on_dropped_(std::move(*value));
+        }
+
+        bool try_reserve() {
+            auto depth = depth_.load(std::memory_order_relaxed);
+            while (depth < capacity_) {
+                if (depth_.compare_exchange_weak(depth, depth + 1, std::memory_order_acq_rel)) {
+                    update_high_water_mark(depth + 1);
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        bool wait_reserve(std::chrono::steady_clock::time_point deadline) {
+            std::unique_lock<std::mutex> locker(mutex);
+            blocked.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            auto reserved = space.wait_until(locker, deadline, [this] {
+                return try_reserve();
+            });
+            blocked.fetch_sub(1, std::memory_order_relaxed);
+            return reserved;
+        }
+
+        void notify_space() {
+            // pairs with fence in wait_reserve
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (blocked.load(std::memory_order_relaxed) > 0) {
+                std::lock_guard<std::mutex> locker(mutex);
+                space.notify_all();
+            }
+        }
+
+        void update_high_water_mark(size_t depth) {
+            auto mark = high_water_mark_.load(std::memory_order_relaxed);
+            while (depth > mark &&
+                   !high_water_mark_.compare_exchange_weak(mark, depth, std::memory_order_relaxed)) {
+            }
+        }
+
+        ConcurrentQueue<Value> queue{};
+        const size_t capacity_;
+        const OverflowPolicy policy_;
+        const std::function<void(Value &&value)> on_dropped_;
+
+        std::atomic<size_t> depth_{0};
+        std::atomic<size_t> high_water_mark_{0};
+        std::atomic<uint64_t> rejected_{0};
+        std::atomic<uint64_t> dropped_{0};
+
+        std::atomic<size_t> blocked{0};
+        std::mutex mutex{};
+        std::condition_variable space{};
+    };
+}
@@ -6,49 +6,145 @@
 
 #pragma once
 
-#include <queue>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <limits>
 #include <mutex>
-#include <shared_mutex>
-#include <thread>
-
-namespace {
-    constexpr auto wait_time = std::chrono::milliseconds(1);
-
-    std::unique_lock<std::shared_mutex> lock(std::shared_mutex &mutex) {
-        while (true) {
-            try {
-                std::unique_lock<std::shared_mutex> lock(mutex);
-                return std::move(lock);
-            } catch (...) {
-            }
-            std::this_thread::sleep_for(wait_time);
-        }
-    }
-}
+#include <optional>
+#include <utility>
 
 namespace pie::concurrent {
+    /**
+     * Lock-free multi-producer / single-consumer queue (Vyukov node based MPSC).
+     * push is wait-free and can be called from any thread.
+     * try_pop, pop_all, wait_pop and empty must be called only from single consumer thread.
+     * Mutex is taken only to wake consumer sleeping in wait_pop.
+     */
     template<typename Value>
     class ConcurrentQueue {
     public:
-        void push(const Value &value) {
-            auto locker = lock(mutex);
-            queue.push(value);
+        ConcurrentQueue() {
+            auto stub = new Node();
+            head.store(stub, std::memory_order_relaxed);
+            tail = stub;
+        }
+
+        ~ConcurrentQueue() {
+            while (try_pop()) {
+            }
+
+            delete tail;
+        }
+
+        ConcurrentQueue(const ConcurrentQueue &) = delete;
+
+        ConcurrentQueue &operator=(const ConcurrentQueue &) = delete;
+
+        void push(Value value) {
+            auto node = new Node(std::move(value));
+            auto prev = head.exchange(node, std::memory_order_acq_rel);
+            prev->next.store(node, std::memory_order_release);
+
+            // pairs with fence in wait_pop, either consumer sees the node or producer sees waiting flag
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (waiting.load(std::memory_order_relaxed)) {
+                std::lock_guard<std::mutex> locker(mutex);
+                cv.notify_one();
+            }
         }
 
-        Value pop() {
-            auto locker = lock(mutex);
-            auto value = queue.front();
-            queue.pop();
+        /**
+         * @return next value or std::nullopt if queue is empty (or producer is in the middle of push)
+         */
+        std::optional<Value> try_pop() {
+            auto next = tail->next.load(std::memory_order_acquire);
+            if (!next)
+                return std::nullopt;
+
+            std::optional<Value> value{std::move(next->value)};
+            next->value.reset();
+            delete tail;
+            tail = next;
             return value;
         }
 
-        bool empty() {
-            auto locker = lock(mutex);
-            return queue.empty();
+        /**
+         * Pop values currently in queue and pass them to consumer
+         * @param consumer - callable with Value&&
+         * @param max - max number of values to pop
+         * @return number of popped values
+         */
+        template<typename Consumer>
+        size_t pop_all(Consumer &&consumer, size_t max = std::numeric_limits<size_t>::max()) {
+            size_t cnt{0};
+            while (cnt < max) {
+                auto value = try_pop();
+                if (!value)
+                    break;
+
+                consumer(std::move(*value));
+                ++cnt;
+            }
+
+            return cnt;
+        }
+
+        /**
+         * Block until value is available or deadline expires
+         */
+        std::optional<Value> wait_pop(std::chrono::steady_clock::time_point deadline) {
+            if (auto value = try_pop())
+                return value;
+
+            std::unique_lock<std::mutex> locker(mutex);
+            waiting.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            cv.wait_until(locker, deadline, [this] {
+                return has_next();
+            });
+            waiting.store(false, std::memory_order_relaxed);
+            locker.unlock();
+            return try_pop();
+        }
+
+        /**
+         * Block until value is available
+         */
+        Value wait_pop() {
+            while (true) {
+                if (auto value = wait_pop(std::chrono::steady_clock::now() + std::chrono::seconds(1)))
+                    return std::move(*value);
+            }
+        }
+
+        [[nodiscard]] bool empty() const {
+            return !has_next();
         }
 
     private:
-        std::queue<Value> queue{};
-        std::shared_mutex mutex{};
+        struct Node {
+            Node() = default;
+
+            explicit Node(Value &&value) : value(std::move(value)) {
+            }
+
+            std::atomic<Node *> next{nullptr};
+            std::optional<Value> value{};
+        };
+
+        [[nodiscard]] bool has_next() const {
+            return tail->next.load(std::memory_order_acquire) != nullptr;
+        }
+
+        // producers side
+        alignas(64) std::atomic<Node *> head{nullptr};
+        // consumer side
+        alignas(64) Node *tail{nullptr};
+
+        std::atomic<bool> waiting{false};
+        std::mutex mutex{};
+        std::condition_variable cv{};
     };
 }
@@ -0,0 +1,118 @@
+/**
+ * @file RingBuffer.h
+ * @author Ilija Poznic
+ * @date 2025
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+
+namespace pie::concurrent {
+    /**
+     * Bounded lock-free multi-producer / single-consumer ring (Vyukov array queue).
+     * All slots are allocated in constructor, values are filled and consumed in place.
+     * try_push can be called from any thread, try_pop, pop_all and empty only from single consumer thread.
+     */
+    template<typename Value>
+    class RingBuffer {
+    public:
+        /**
+         * @param capacity - rounded up to power of two
+         */
+        explicit RingBuffer(size_t capacity) {
+            size_t size{2};
+            while (size < capacity)
+                size <<= 1;
+
+            mask = size - 1;
+            cells = std::make_unique<Cell[]>(size);
+            for (size_t i = 0; i < size; ++i)
+                cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        RingBuffer(const RingBuffer &) = delete;
+
+        RingBuffer &operator=(const RingBuffer &) = delete;
+
+        /**
+         * @param fill - callable with Value&, called only if there is free slot
+         * @return false if ring is full
+         */
+        template<typename Fill>
+        bool try_push(Fill &&fill) {
+            auto pos = enqueue_pos.load(std::memory_order_relaxed);
+            while (true) {
+                auto &cell = cells[pos & mask];
+                auto sequence = cell.sequence.load(std::memory_order_acquire);
+                auto diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+                if (diff == 0) {
+                    if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        fill(cell.value);
+                        cell.sequence.store(pos + 1, std::memory_order_release);
+                        return true;
+                    }
+                } else if (diff < 0) {
+                    return false;
+                } else {
+                    pos = enqueue_pos.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        /**
+         * @param consume - callable with Value&
+         * @return false if ring is empty (or producer is in the middle of push)
+         */
+        template<typename Consume>
+        bool try_pop(Consume &&consume) {
+            auto &cell = cells[dequeue_pos & mask];
+            auto sequence = cell.sequence.load(std::memory_order_acquire);
+            if (sequence != dequeue_pos + 1)
+                return false;
+
+            consume(cell.value);
+            cell.sequence.store(dequeue_pos + mask + 1, std::memory_order_release);
+            ++dequeue_pos;
+            return true;
+        }
+
+        /**
+         * @return number of consumed values
+         */
+        template<typename Consume>
+        size_t pop_all(Consume &&consume, size_t max = std::numeric_limits<size_t>::max()) {
+            size_t cnt{0};
+            while (cnt < max && try_pop(consume))
+                ++cnt;
+
+            return cnt;
+        }
+
+        [[nodiscard]] bool empty() const {
+            return cells[dequeue_pos & mask].sequence.load(std::memory_order_acquire) != dequeue_pos + 1;
+        }
+
+        [[nodiscard]] size_t capacity() const {
+            return mask + 1;
+        }
+
+    private:
+        struct Cell {
+            std::atomic<size_t> sequence{0};
+            Value value{};
+        };
+
+        std::unique_ptr<Cell[]> cells;
+        size_t mask{0};
+
+        // producers side
+        alignas(64) std::atomic<size_t> enqueue_pos{0};
+        // consumer side
+        alignas(64) size_t dequeue_pos{0};
+    };
+}
@@ -0,0 +1,100 @@
+/**
+* @file ByteView.h
+* @author Ilija Poznic
+* @date 2025
+*/
+
+#pragma once
+
+#include <dbus/dbus.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace pie::dbus {
+    /**
+     * Read only bytes inside a DBusMessage (e.g. "ay" argument) or a shared buffer, the owner is referenced
+     * while any copy of the view is alive. Copy is a reference count increment, no allocation. Use to_vector()
+     * to keep the bytes without keeping the whole owner.
+     */
+    class ByteView {
+    public:
+        ByteView() = default;
+
+        /**
+         * @param owner - message holding data, referenced by the view
+         */
+        ByteView(DBusMessage *owner, const uint8_t *data, size_t size) : owner(owner), p_data(data), size_(size) {
+            if (owner)
+                dbus_message_ref(owner);
+        }
+
+        ~ByteView() {
+            if (owner)
+                dbus_message_unref(owner);
+        }
+
+        /**
+         * @param buffer - storage holding data (e.g. packet read from socket), shared by the view
+         */
+        ByteView(std::shared_ptr<const void> buffer, const uint8_t *data, size_t size)
+            : buffer(std::move(buffer)), p_data(data), size_(size) {
+        }
+
+        ByteView(const ByteView &other) : ByteView(other.owner, other.p_data, other.size_) {
+            buffer = other.buffer;
+        }
+
+        ByteView(ByteView &&other) noexcept
+            : owner(std::exchange(other.owner, nullptr)),
+              buffer(std::move(other.buffer)),
+              p_data(std::exchange(other.p_data, nullptr)),
+              size_(std::exchange(other.size_, 0)) {
+        }
+
+        ByteView &operator=(ByteView other) noexcept {
+            std::swap(owner, other.owner);
+            std::swap(buffer, other.buffer);
+            std::swap(p_data, other.p_data);
+            std::swap(size_, other.size_);
+            return *this;
+        }
+
+        [[nodiscard]] const uint8_t *data() const {
+            return p_data;
+        }
+
+        [[nodiscard]] size_t size() const {
+            return size_;
+        }
+
+        [[nodiscard]] bool empty() const {
+            return size_ == 0;
+        }
+
+        [[nodiscard]] const uint8_t *begin() const {
+            return p_data;
+        }
+
+        [[nodiscard]] const uint8_t *end() const {
+            return p_data + size_;
+        }
+
+        const uint8_t &operator[](size_t index) const {
+            return p_data[index];
+        }
+
+        [[nodiscard]] std::vector<uint8_t> to_vector() const {
+            return {begin(), end()};
+        }
+
+    private:
+        DBusMessage *owner{nullptr};
+        std::shared_ptr<const void> buffer{};
+        const uint8_t *p_data{nullptr};
+        size_t size_{0};
+    };
+}
@@ -7,44 +7,372 @@
 #include "DBus.h"
 #include "pie/dbus/helper/dbus.h"
 #include "pie/dbus/DBusOnMessage.h"
-#include "pie/concurrent/ConcurrentQueue.h"
 #include "pie/logging/console_helpers.h"
+#include "pie/logging/log.h"
+#include "pie/trace/Probe.h"
+#include "pie/trace/Trace.h"
+#include "helper/dbus_metrics.h"
+#include "helper/DBusEventLoop.h"
 #include "helper/DBusMessageExecuteBase.h"
 #include "helper/SendDBusMessageExecute.h"
 #include "helper/SendWithReplyDBusMessageExecute.h"
 
+#include <sys/epoll.h>
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
 #include <thread>
+#include <unordered_map>
 
 namespace {
-    uint32_t tag_cnt{0};
     uint32_t cnt{0};
+    constexpr size_t max_handler_histograms{64};
+
+    inline const pie::logging::LogTag &TAG = pie::logging::register_tag("DBus");
+
+    const pie::logging::LogFormat &message_format() {
+        static const auto &format = pie::logging::register_format(
+            TAG, "{} message: {type: {}, destination: {}, path: {}, iface: {}, member: {}, serial: {}}");
+        return format;
+    }
+
+    const pie::logging::LogFormat &send_message_format() {
+        static const auto &format = pie::logging::register_format(
+            TAG, "DBus::send max_wait_time_ms: {}, message: {type: {}, destination: {}, path: {}, iface: {}, "
+            "member: {}, serial: {}}");
+        return format;
+    }
+
+    const pie::logging::LogFormat &handler_stall_format() {
+        static const auto &format = pie::logging::register_format(
+            TAG, "handler over budget: {} us, budget: {} us [path: {}, iface: {}, member: {}, serial: {}]");
+        return format;
+    }
 
-    const std::string TAG{"DBus"};
+    const pie::logging::LogFormat &iteration_stall_format() {
+        static const auto &format = pie::logging::register_format(
+            TAG, "loop iteration over budget: {} us, budget: {} us [commands: {} in {} us, dispatch: {} us, "
+            "flush: {} us, slowest handler: {} us, path: {}, iface: {}, member: {}]");
+        return format;
+    }
+
+    uint64_t to_us(std::chrono::steady_clock::duration duration) {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(duration).count());
+    }
+
+    const pie::logging::LogFormat &received_message_format() {
+        static const auto &format = pie::logging::register_format(
+            TAG, "msg received [type: {}, path: {}, iface: {}, member: {}, serial: {}]");
+        return format;
+    }
+
+    void log_msg(const std::shared_ptr<pie::Logger> &logger, const std::shared_ptr<DBusMessage> &msg,
+                 const char *prefix) {
+        if (!pie::logger::is_enabled(logger, TAG, pie::LogLevel::Trace))
+            return;
 
-    void log_msg(std::shared_ptr<pie::Logger> &logger, std::shared_ptr<DBusMessage> msg, const std::string &prefix) {
         auto msg_info = pie::dbus::get_message_info(msg);
-        std::stringstream ss{};
-        ss << prefix << " message: " << msg_info;
-        pie::logger::log_if_debug(logger, pie::LogLevel::Trace, ss.str());
+        pie::logger::log_format<pie::LogLevel::Trace>(
+            logger, message_format(), prefix, pie::dbus::to_string(msg_info.type), msg_info.destination,
+            msg_info.path, msg_info.iface, msg_info.member, msg_info.serial);
     }
 }
 
 namespace pie::dbus {
+    /**
+     * Slowest handled message of current loop iteration
+     */
+    struct DBusSlowestHandler {
+        std::chrono::steady_clock::duration elapsed{};
+        std::string path{};
+        std::string iface{};
+        std::string member{};
+    };
+
     struct DBusData {
+        explicit DBusData(const DBusConfig &config)
+            : msg_queue(config.queue_capacity, config.overflow_policy,
+                        [](std::shared_ptr<DBusMessageExecuteBase> &&dbus_msg_exec) {
+                            dbus_msg_exec->cancel({DBusResultCode::E_Dropped, "Dropped from full command queue"});
+                        }),
+              config(config) {
+        }
+
         std::shared_ptr<pie::Logger> logger;
         std::thread dbus_thread;
-        pie::dbus::DBusState state{pie::dbus::DBusState::Stopped};
+        std::atomic<pie::dbus::DBusState> state{pie::dbus::DBusState::Stopped};
         DBusConnection *conn{nullptr};
         std::vector<std::weak_ptr<DBusOnMessage> > subscribers{};
-        std::string tag;
-        pie::concurrent::ConcurrentQueue<std::shared_ptr<DBusMessageExecuteBase> > msg_queue{};
+        pie::concurrent::BoundedQueue<std::shared_ptr<DBusMessageExecuteBase> > msg_queue;
+        pie::dbus::DBusEventLoop event_loop{};
+        pie::dbus::DBusRouter router{};
+        pie::dbus::DBusConfig config;
+
+        // handler time histograms keyed by path hash, used only by DBus thread
+        std::unordered_multimap<size_t, std::pair<std::string, pie::metrics::Histogram *> > handler_histograms{};
+
+        // stats, written only by DBus thread
+        std::array<std::atomic<uint64_t>, std::tuple_size_v<decltype(DBusStats::batch_sizes)> > batch_sizes{};
+        std::atomic<uint64_t> batches{0};
+        std::atomic<uint64_t> commands{0};
+
+        // budget overruns, counters written only by DBus thread
+        DBusSlowestHandler slowest{};
+        std::atomic<uint64_t> iteration_stalls{0};
+        std::atomic<uint64_t> handler_stalls{0};
+        std::mutex stalls_mutex{};
+        std::vector<DBusStall> stall_offenders{};
     };
 
-    DBus::DBus(const std::shared_ptr<pie::Logger> &logger) {
-        data = std::make_unique<DBusData>();
-        std::stringstream ss{};
-        ss << TAG << tag_cnt++;
-        data->tag = ss.str();
+    namespace {
+        DBusResult enqueue(DBusData &data, const std::shared_ptr<DBusMessageExecuteBase> &cmd,
+                           std::chrono::steady_clock::time_point deadline) {
+            // DBus thread is the only consumer, it must never wait for free space
+            if (std::this_thread::get_id() == data.dbus_thread.get_id())
+                deadline = std::chrono::steady_clock::now();
+
+            PIE_PROBE(queue_push, static_cast<uint64_t>(data.msg_queue.depth()));
+            auto result = data.msg_queue.push(cmd, deadline);
+            if (result != pie::concurrent::PushResult::Success) {
+                DBusResult dbus_result{};
+                dbus_result.code = DBusResultCode::E_QueueFull;
+                dbus_result.error = result == pie::concurrent::PushResult::Rejected
+                                        ? "Command queue full"
+                                        : "Command queue full, no space before deadline";
+                return dbus_result;
+            }
+
+            data.event_loop.wakeup();
+            return {};
+        }
+
+        DBusConnection *connect(const DBusConfig &config, DBusError *dbus_error) {
+            switch (config.bus_type) {
+                case DBusBusType::System:
+                    return dbus_bus_get(DBUS_BUS_SYSTEM, dbus_error);
+                case DBusBusType::Session:
+                    return dbus_bus_get(DBUS_BUS_SESSION, dbus_error);
+                case DBusBusType::Address: {
+                    auto conn = dbus_connection_open_private(config.address.c_str(), dbus_error);
+                    if (!conn)
+                        return nullptr;
+
+                    if (!dbus_bus_register(conn, dbus_error)) {
+                        dbus_connection_close(conn);
+                        dbus_connection_unref(conn);
+                        return nullptr;
+                    }
+
+                    return conn;
+                }
+            }
+
+            dbus_set_error_const(dbus_error, DBUS_ERROR_BAD_ADDRESS, "Unknown bus type");
+            return nullptr;
+        }
+
+        void disconnect(const DBusConfig &config, DBusConnection *conn) {
+            // shared connections returned by dbus_bus_get must not be closed
+            if (config.bus_type == DBusBusType::Address) {
+                dbus_connection_close(conn);
+                dbus_connection_unref(conn);
+            }
+        }
+
+        /**
+         * Execute up to config.max_batch queued commands
+         * @return number of executed commands
+         */
+        size_t execute_batch(DBusData &data, DBusConnection *conn) {
+            PIE_TRACE_SCOPE("DBus::execute_batch");
+            auto batch_size = data.msg_queue.pop_all([conn](std::shared_ptr<DBusMessageExecuteBase> &&dbus_msg_exec) {
+                PIE_TRACE_SCOPE("DBus::exec");
+                const auto &metrics = dbus_metrics();
+                auto start = std::chrono::steady_clock::now();
+                auto wait = start - dbus_msg_exec->created();
+                PIE_PROBE(queue_pop, static_cast<uint64_t>(std::chrono::nanoseconds{wait}.count()));
+                metrics.queue_wait.record(wait);
+                dbus_msg_exec->exec(conn);
+                metrics.exec.record(std::chrono::steady_clock::now() - start);
+            }, data.config.max_batch);
+
+            if (batch_size == 0)
+                return 0;
+
+            size_t bucket{0};
+            while ((batch_size >> (bucket + 1)) != 0 && bucket + 1 < data.batch_sizes.size())
+                ++bucket;
+
+            data.batch_sizes[bucket].fetch_add(1, std::memory_order_relaxed);
+            data.batches.fetch_add(1, std::memory_order_relaxed);
+            data.commands.fetch_add(batch_size, std::memory_order_relaxed);
+            return batch_size;
+        }
+
+        bool is_handled(DBusHandlerResult result) {
+            return result == DBUS_HANDLER_RESULT_HANDLED || result == DBUS_HANDLER_RESULT_NEED_MEMORY;
+        }
+
+        /**
+         * Histogram is registered on first handled message of path, paths above max_handler_histograms share one
+         */
+        pie::metrics::Histogram &handler_histogram(DBusData &data, std::string_view path) {
+            auto hash = DBusRouter::hash(path);
+            auto [begin, end] = data.handler_histograms.equal_range(hash);
+            for (auto it = begin; it != end; ++it) {
+                if (it->second.first == path)
+                    return *it->second.second;
+            }
+
+            static const char *help = "Time to handle incoming message by object path";
+            if (data.handler_histograms.size() >= max_handler_histograms)
+                return pie::metrics::histogram("dbus_handler_ns", "path=\"*\"", help);
+
+            std::string labels{"path=\""};
+            labels += path;
+            labels += "\"";
+            auto &histogram = pie::metrics::histogram("dbus_handler_ns", labels, help);
+            data.handler_histograms.emplace(hash, std::make_pair(std::string{path}, &histogram));
+            return histogram;
+        }
+
+        /**
+         * Count and log handler overrun, message is kept if it is among max_stall_offenders slowest
+         */
+        void record_handler_stall(DBusData &data, const DBusMessageInfo &msg_info,
+                                  std::chrono::steady_clock::duration elapsed) {
+            data.handler_stalls.fetch_add(1, std::memory_order_relaxed);
+            dbus_metrics().handler_stalls.add();
+            pie::logger::log_format<LogLevel::Warning>(
+                data.logger, handler_stall_format(), to_us(elapsed), data.config.handler_budget.count(),
+                msg_info.path, msg_info.iface, msg_info.member, msg_info.serial);
+
+            auto ns = static_cast<uint64_t>(std::chrono::nanoseconds{elapsed}.count());
+            std::lock_guard<std::mutex> locker(data.stalls_mutex);
+            auto &offenders = data.stall_offenders;
+            auto it = std::find_if(offenders.begin(), offenders.end(), [&msg_info](const DBusStall &stall) {
+                return stall.path == msg_info.path && stall.iface == msg_info.iface && stall.member == msg_info.member;
+            });
+
+            if (it == offenders.end()) {
+                if (offenders.size() < max_stall_offenders) {
+                    it = offenders.emplace(offenders.end());
+                } else {
+                    it = std::min_element(offenders.begin(), offenders.end(), [](const auto &a, const auto &b) {
+                        return a.max_ns < b.max_ns;
+                    });
+                    if (it->max_ns >= ns)
+                        return;
+
+                    *it = DBusStall{};
+                }
+
+                it->path = msg_info.path;
+                it->iface = msg_info.iface;
+                it->member = msg_info.member;
+            }
+
+            ++it->count;
+            it->max_ns = std::max(it->max_ns, ns);
+            it->last_ns = ns;
+        }
+
+        void check_handler_budget(DBusData &data, const DBusMessageInfo &msg_info,
+                                  std::chrono::steady_clock::duration elapsed) {
+            if (elapsed > data.slowest.elapsed) {
+                data.slowest.elapsed = elapsed;
+                data.slowest.path = msg_info.path;
+                data.slowest.iface = msg_info.iface;
+                data.slowest.member = msg_info.member;
+            }
+
+            auto budget = data.config.handler_budget;
+            if (budget.count() > 0 && elapsed > budget)
+                record_handler_stall(data, msg_info, elapsed);
+        }
+
+        /**
+         * @param start, dispatch_start, flush_start - start of iteration and its stages
+         */
+        void check_iteration_budget(DBusData &data, size_t commands, std::chrono::steady_clock::time_point start,
+                                    std::chrono::steady_clock::time_point dispatch_start,
+                                    std::chrono::steady_clock::time_point flush_start) {
+            auto end = std::chrono::steady_clock::now();
+            auto elapsed = end - start;
+            dbus_metrics().iteration.record(elapsed);
+            auto budget = data.config.iteration_budget;
+            if (budget.count() > 0 && elapsed > budget) {
+                data.iteration_stalls.fetch_add(1, std::memory_order_relaxed);
+                dbus_metrics().iteration_stalls.add();
+                const auto &slowest = data.slowest;
+                pie::logger::log_format<LogLevel::Warning>(
+                    data.logger, iteration_stall_format(), to_us(elapsed), budget.count(), commands,
+                    to_us(dispatch_start - start), to_us(flush_start - dispatch_start), to_us(end - flush_start),
+                    to_us(slowest.elapsed), slowest.path, slowest.iface, slowest.member);
+            }
+
+            data.slowest.elapsed = {};
+        }
+
+        /**
+         * Offer every queued incoming message to subscribers.
+         * Messages not handled by subscribers are dispatched by libdbus (e.g. UnknownMethod error reply)
+         */
+        void dispatch_incoming(DBusData &data, DBusConnection *conn) {
+            PIE_TRACE_SCOPE("DBus::dispatch_incoming");
+            while (dbus_connection_get_dispatch_status(conn) == DBUS_DISPATCH_DATA_REMAINS) {
+                auto msg_p = dbus_connection_borrow_message(conn);
+                if (!msg_p) {
+                    dbus_connection_dispatch(conn);
+                    continue;
+                }
+
+                // non owning pointer without control block, message is owned by connection while borrowed
+                std::shared_ptr<DBusMessage> msg{std::shared_ptr<DBusMessage>{}, msg_p};
+                auto msg_info = pie::dbus::get_message_info(msg_p);
+                pie::logger::log_format<LogLevel::Trace>(
+                    data.logger, received_message_format(), pie::dbus::to_string(msg_info.type), msg_info.path,
+                    msg_info.iface, msg_info.member, msg_info.serial);
+                dbus_metrics().received[static_cast<size_t>(dbus_message_get_type(msg_p))]->add();
+                PIE_PROBE(dbus_receive, dbus_message_get_type(msg_p), msg_info.path.data(), msg_info.member.data(),
+                          msg_info.serial);
+
+                PIE_PROBE(dispatch_start, msg_info.path.data(), msg_info.serial);
+                auto start = std::chrono::steady_clock::now();
+                auto handled = false;
+                {
+                    PIE_TRACE_SCOPE("DBus::route");
+                    handled = is_handled(data.router.route(msg_info, msg));
+                }
+
+                for (auto it = data.subscribers.begin(); !handled && it != data.subscribers.end(); ++it) {
+                    PIE_TRACE_SCOPE("DBus::on_message");
+                    if (auto subscriber = it->lock())
+                        handled = is_handled(subscriber->on_message(msg_info, msg));
+                }
+
+                auto elapsed = std::chrono::steady_clock::now() - start;
+                PIE_PROBE(dispatch_end, msg_info.path.data(), msg_info.serial, static_cast<int>(handled));
+                check_handler_budget(data, msg_info, elapsed);
+                if (handled) {
+                    handler_histogram(data, msg_info.path).record(elapsed);
+                    dbus_connection_steal_borrowed_message(conn, msg_p);
+                    dbus_message_unref(msg_p);
+                } else {
+                    PIE_TRACE_SCOPE("DBus::dispatch");
+                    dbus_connection_return_message(conn, msg_p);
+                    dbus_connection_dispatch(conn);
+                }
+            }
+        }
+    }
+
+    DBus::DBus(const std::shared_ptr<pie::Logger> &logger, const DBusConfig &config) {
+        data = std::make_unique<DBusData>(config);
+        if (data->config.max_batch == 0)
+            data->config.max_batch = 1;
+
         data->logger = logger;
         data->state = pie::dbus::DBusState::Initializing;
         data->dbus_thread = std::thread(&DBus::execute, this);
@@ -66,6 +394,7 @@ namespace pie::dbus {
 
     DBus::~DBus() {
         data->state = DBusState::Stopped;
+        data->event_loop.wakeup();
         if (data->dbus_thread.joinable())
             data->dbus_thread.join();
 
@@ -77,92 +406,116 @@ namespace pie::dbus {
         return data->state;
     }
 
+    DBusStats DBus::stats() const {
+        DBusStats stats{};
+        for (size_t i = 0; i < stats.batch_sizes.size(); ++i)
+            stats.batch_sizes[i] = data->batch_sizes[i].load(std::memory_order_relaxed);
+
+        stats.batches = data->batches.load(std::memory_order_relaxed);
+        stats.commands = data->commands.load(std::memory_order_relaxed);
+        stats.queue_depth = data->msg_queue.depth();
+        stats.queue_high_water_mark = data->msg_queue.high_water_mark();
+        stats.queue_rejected = data->msg_queue.rejected();
+        stats.queue_dropped = data->msg_queue.dropped();
+        return stats;
+    }
+
+    DBusStalls DBus::stalls() const {
+        DBusStalls stalls{};
+        stalls.iterations = data->iteration_stalls.load(std::memory_order_relaxed);
+        stalls.handlers = data->handler_stalls.load(std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> locker(data->stalls_mutex);
+            stalls.worst = data->stall_offenders;
+        }
+
+        std::sort(stalls.worst.begin(), stalls.worst.end(), [](const DBusStall &a, const DBusStall &b) {
+            return a.max_ns > b.max_ns;
+        });
+        return stalls;
+    }
+
     void DBus::subscribe(const std::weak_ptr<pie::dbus::DBusOnMessage> &subscriber) {
         data->subscribers.emplace_back(subscriber);
     }
 
+    DBusRouter &DBus::router() {
+        return data->router;
+    }
+
 
     void DBus::execute() {
+        PIE_TRACE_THREAD_NAME("DBus");
         DBusError dbus_error{};
         dbus_error_init(&dbus_error);
         auto logger = data->logger;
-        auto conn = dbus_bus_get(DBUS_BUS_SYSTEM, &dbus_error);
-        if (dbus_error_is_set(&dbus_error)) {
+        auto conn = connect(data->config, &dbus_error);
+        if (dbus_error_is_set(&dbus_error) || !conn) {
             std::stringstream ss{};
             ss << "DBus error name: " << dbus_error.name;
             ss << ", message: " << dbus_error.message;
-            pie::logger::log_if_debug(logger, data->tag, LogLevel::Trace, ss.str());
+            pie::logger::log(logger, TAG, LogLevel::Warning, ss.str());
             dbus_error_free(&dbus_error);
             data->state = DBusState::Error;
             return;
         }
 
+        if (!data->event_loop.attach(conn)) {
+            pie::logger::log(logger, TAG, LogLevel::Warning, "failed to attach event loop");
+            data->event_loop.detach(conn);
+            disconnect(data->config, conn);
+            data->state = DBusState::Error;
+            return;
+        }
+
         data->conn = conn;
         data->state = DBusState::Running;
-        pie::logger::log_if_debug(logger, data->tag, LogLevel::Trace, "execute loop started");
+        pie::logger::log_if_debug(logger, TAG, LogLevel::Trace, "execute loop started");
         while (data->state == DBusState::Running) {
             try {
-                if (!data->msg_queue.empty()) {
-                    auto dbus_msg_exec = data->msg_queue.pop();
-                    dbus_msg_exec->exec(conn);
+                auto start = std::chrono::steady_clock::now();
+                auto commands = execute_batch(*data, conn);
+                auto dispatch_start = std::chrono::steady_clock::now();
+                dispatch_incoming(*data, conn);
+                // single flush for queued commands and replies sent from subscribers
+                auto flush_start = std::chrono::steady_clock::now();
+                {
+                    PIE_TRACE_SCOPE("DBus::flush");
+                    PIE_PROBE(flush_start);
+                    dbus_connection_flush(conn);
+                    PIE_PROBE(flush_end);
                 }
 
-                dbus_connection_read_write_dispatch(conn, 1);
-                auto msg_p = dbus_connection_borrow_message(conn);
-                if (msg_p) {
-                    bool return_msg{true};
-                    // parse message
-                    std::shared_ptr<DBusMessage> msg{
-                        msg_p, [](DBusMessage *msg) {
-                        }
-                    };
-                    auto msg_info = pie::dbus::get_message_info(msg);
-                    auto msg_info_as_string = pie::dbus::get_message_info(msg_info);
-                    pie::logger::log_if_debug(logger, data->tag, LogLevel::Trace, msg_info_as_string);
-                    for (const auto &weak_subscriber: data->subscribers) {
-                        if (auto subscriber = weak_subscriber.lock()) {
-                            auto result = subscriber->on_message(msg_info, msg);
-                            if (result == DBUS_HANDLER_RESULT_HANDLED ||
-                                result == DBUS_HANDLER_RESULT_NEED_MEMORY) {
-                                dbus_connection_steal_borrowed_message(conn, msg_p);
-                                dbus_message_unref(msg_p);
-                                return_msg = false;
-                                break;
-                            }
-                        }
-                    }
+                check_iteration_budget(*data, commands, start, dispatch_start, flush_start);
 
-                    if (return_msg)
-                        dbus_connection_return_message(conn, msg_p);
-                }
+                // budget exhausted, do not block while commands are still queued. Flush and other libdbus
+                // calls can read incoming messages into connection queue, socket is drained then but
+                // messages wait for dispatch
+                auto idle = data->msg_queue.empty() &&
+                            dbus_connection_get_dispatch_status(conn) != DBUS_DISPATCH_DATA_REMAINS;
+                data->event_loop.run_once(idle ? -1 : 0);
             } catch (const std::exception &e) {
                 logger->log(LogLevel::Warning, e.what());
             }
         }
 
-
-        pie::logger::log_if_debug(logger, data->tag, LogLevel::Trace, "execute loop ended");
+        data->event_loop.detach(conn);
+        data->conn = nullptr;
+        disconnect(data->config, conn);
+        pie::logger::log_if_debug(logger, TAG, LogLevel::Trace, "execute loop ended");
     }
 
 
     std::tuple<DBusResult, std::shared_ptr<DBusMessage> > DBus::send_with_reply(
         std::shared_ptr<DBusMessage> &&msg, std::chrono::milliseconds max_wait_time) {
-        std::stringstream ss{};
-        ss << data->tag << "|DBus::send_with_reply";
-        log_msg(data->logger, msg, ss.str());
-        auto max_wait_time_ms = max_wait_time.count();
-        auto cmd = std::make_shared<pie::dbus::SendWithReplyDBusMessageExecute>(std::move(msg));
-        auto sleep = std::chrono::milliseconds(1);
-        data->msg_queue.push(cmd);
-        auto cnt{0};
-        while (cnt < max_wait_time_ms) {
-            std::this_thread::sleep_for(sleep);
-            cnt++;
-            if (cmd->status() == DBusMessageExecuteBase::Status::Finished)
-                break;
-        }
-
-        if (cmd->status() == DBusMessageExecuteBase::Status::Finished) {
+        log_msg(data->logger, msg, "DBus::send_with_reply");
+        auto deadline = std::chrono::steady_clock::now() + max_wait_time;
+        auto cmd = std::make_shared<pie::dbus::SendWithReplyDBusMessageExecute>(std::move(msg), max_wait_time);
+        auto enqueue_result = enqueue(*data, cmd, deadline);
+        if (enqueue_result.code != DBusResultCode::Success)
+            return {enqueue_result, nullptr};
+
+        if (cmd->wait_until(deadline)) {
             auto result_op = cmd->result();
             if (result_op.has_value())
                 return result_op.value();
@@ -173,42 +526,64 @@ namespace pie::dbus {
             return {dbus_result, nullptr};
         }
 
+        dbus_metrics().command_timeouts.add();
         DBusResult dbus_result{};
         dbus_result.code = DBusResultCode::E_CMD_Timeout;
         dbus_result.error = "Command Timeout";
         return {dbus_result, nullptr};
     }
 
+    void DBus::call_async(std::shared_ptr<DBusMessage> &&msg, DBusReplyCallback callback,
+                          std::chrono::milliseconds timeout) {
+        log_msg(data->logger, msg, "DBus::call_async");
+        if (data->state != DBusState::Running) {
+            if (callback)
+                callback({DBusResultCode::Error, "DBus is not running"}, nullptr);
+            return;
+        }
+
+        auto cmd = std::make_shared<pie::dbus::SendWithReplyDBusMessageExecute>(
+            std::move(msg), timeout, std::move(callback));
+        auto result = enqueue(*data, cmd, std::chrono::steady_clock::now() + timeout);
+        if (result.code != DBusResultCode::Success)
+            cmd->cancel(result);
+    }
+
+    std::future<std::tuple<DBusResult, std::shared_ptr<DBusMessage> > > DBus::call_async(
+        std::shared_ptr<DBusMessage> &&msg, std::chrono::milliseconds timeout) {
+        auto promise = std::make_shared<std::promise<std::tuple<DBusResult, std::shared_ptr<DBusMessage> > > >();
+        auto future = promise->get_future();
+        call_async(std::move(msg), [promise](const DBusResult &result, std::shared_ptr<DBusMessage> reply) {
+            promise->set_value({result, std::move(reply)});
+        }, timeout);
+        return future;
+    }
+
     DBusResult DBus::send(std::shared_ptr<DBusMessage> &&msg, std::chrono::milliseconds max_wait_time) {
-        std::stringstream ss{};
-        ss << data->tag << "|DBus::send";
-        auto max_wait_time_ms = max_wait_time.count();
-        ss << " max_wait_time_ms: " << max_wait_time_ms << ", ";
-        log_msg(data->logger, msg, ss.str());
-        auto cmd = std::make_shared<pie::dbus::SendDBusMessageExecute>(std::move(msg));
-        auto sleep = std::chrono::milliseconds(1);
-        data->msg_queue.push(cmd);
-        auto cnt{0};
-        while (cnt < max_wait_time_ms) {
-            std::this_thread::sleep_for(sleep);
-            cnt++;
-            if (cmd->status() == DBusMessageExecuteBase::Status::Finished)
-                break;
+        if (pie::logger::is_enabled(data->logger, TAG, LogLevel::Trace)) {
+            auto msg_info = pie::dbus::get_message_info(msg);
+            pie::logger::log_format<LogLevel::Trace>(
+                data->logger, send_message_format(), max_wait_time.count(), pie::dbus::to_string(msg_info.type),
+                msg_info.destination, msg_info.path, msg_info.iface, msg_info.member, msg_info.serial);
         }
+        auto deadline = std::chrono::steady_clock::now() + max_wait_time;
+        auto cmd = std::make_shared<pie::dbus::SendDBusMessageExecute>(std::move(msg));
+        auto enqueue_result = enqueue(*data, cmd, deadline);
+        if (enqueue_result.code != DBusResultCode::Success)
+            return enqueue_result;
 
-        if (cnt >= max_wait_time_ms) {
+        if (!cmd->wait_until(deadline)) {
+            dbus_metrics().command_timeouts.add();
             DBusResult dbus_result{};
             dbus_result.code = DBusResultCode::E_CMD_Timeout;
             dbus_result.error = "Command Timeout";
             return dbus_result;
         }
 
-        if (cmd->status() == DBusMessageExecuteBase::Status::Finished) {
-            auto result_op = cmd->result();
-            if (result_op.has_value()) {
-                auto [result, msg_rsp] = result_op.value();
-                return result;
-            }
+        auto result_op = cmd->result();
+        if (result_op.has_value()) {
+            auto [result, msg_rsp] = result_op.value();
+            return result;
         }
 
         DBusResult dbus_result{};
@@ -218,9 +593,7 @@ namespace pie::dbus {
     }
 
     DBusResult DBus::reply(std::shared_ptr<DBusMessage> &&msg) {
-        std::stringstream ss{};
-        ss << data->tag << "|DBus::reply";
-        log_msg(data->logger, msg, ss.str());
+        log_msg(data->logger, msg, "DBus::reply");
         auto current_id = std::this_thread::get_id();
         auto dbus_thread_id = data->dbus_thread.get_id();
         if (dbus_thread_id != current_id) {
@@ -230,9 +603,10 @@ namespace pie::dbus {
             return dbus_result;
         }
 
+        // flushed by execute loop after dispatch
         uint32_t id{0};
         auto success = dbus_connection_send(data->conn, msg.get(), &id);
-        dbus_connection_flush(data->conn);
+        PIE_PROBE(dbus_reply, dbus_message_get_reply_serial(msg.get()), id);
 
         auto dbus_result = pie::dbus::DBusResult{};
         if (!success) {
@@ -243,6 +617,40 @@ namespace pie::dbus {
         return dbus_result;
     }
 
+    DBusResult DBus::add_reader(int fd, std::function<bool()> on_readable) {
+        return add_fd(fd, EPOLLIN, [on_readable = std::move(on_readable)](uint32_t) {
+            return on_readable();
+        });
+    }
+
+    DBusResult DBus::add_fd(int fd, uint32_t events, std::function<bool(uint32_t events)> on_ready) {
+        if (data->dbus_thread.get_id() != std::this_thread::get_id())
+            return {DBusResultCode::E_NotOnDBusThread, "Can be called only on DBus thread"};
+
+        if (!data->event_loop.add_fd(fd, events, std::move(on_ready)))
+            return {DBusResultCode::Error, "Failed to add fd: " + std::to_string(fd)};
+
+        return {};
+    }
+
+    DBusResult DBus::modify_fd(int fd, uint32_t events) {
+        if (data->dbus_thread.get_id() != std::this_thread::get_id())
+            return {DBusResultCode::E_NotOnDBusThread, "Can be called only on DBus thread"};
+
+        if (!data->event_loop.modify_fd(fd, events))
+            return {DBusResultCode::Error, "Failed to modify fd: " + std::to_string(fd)};
+
+        return {};
+    }
+
+    DBusResult DBus::remove_fd(int fd) {
+        if (data->dbus_thread.get_id() != std::this_thread::get_id())
+            return {DBusResultCode::E_NotOnDBusThread, "Can be called only on DBus thread"};
+
+        data->event_loop.remove_fd(fd);
+        return {};
+    }
+
 
     std::shared_ptr<DBusMessage> DBus::new_message(std::string &bus_name, std::string &path, std::string &iface,
                                                    std::string &method) {
@@ -7,13 +7,22 @@
 #pragma once
 
 #include "pie/dbus/DBusOnMessage.h"
+#include "pie/dbus/DBusRouter.h"
 #include "pie/dbus/helper/dbus.h"
+#include "pie/concurrent/BoundedQueue.h"
 
 #include <pie/logging/Logger.h>
 
+#include <array>
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
 #include <string>
 #include <memory>
+#include <tuple>
+#include <vector>
 
 using namespace std::chrono_literals;
 
@@ -29,7 +38,9 @@ namespace pie::dbus {
         Success,
         Error,
         E_NotOnDBusThread,
-        E_CMD_Timeout
+        E_CMD_Timeout,
+        E_QueueFull,
+        E_Dropped
     };
 
     struct DBusResult {
@@ -43,11 +54,105 @@ namespace pie::dbus {
         std::shared_ptr<DBusMessage> message{nullptr};
     };
 
+    enum class DBusBusType {
+        System,
+        Session,
+        // any address, e.g. printed by private "dbus-daemon --print-address"
+        Address
+    };
+
+    struct DBusConfig {
+        DBusBusType bus_type{DBusBusType::System};
+
+        /**
+         * Used only with DBusBusType::Address
+         */
+        std::string address{};
+
+        /**
+         * Max number of queued commands executed in one loop iteration.
+         * Outgoing messages of the whole batch are flushed once.
+         */
+        size_t max_batch{64};
+
+        /**
+         * Max number of commands waiting for DBus thread, 0 means unbounded
+         */
+        size_t queue_capacity{1024};
+
+        /**
+         * What to do when queue_capacity is reached:
+         * Block - wait for free space until command deadline, then fail with E_QueueFull
+         * Reject - fail immediately with E_QueueFull
+         * DropOldest - accept command, oldest queued command is finished with E_Dropped on the thread
+         * queueing the new one, queue never holds more than queue_capacity commands
+         */
+        pie::concurrent::OverflowPolicy overflow_policy{pie::concurrent::OverflowPolicy::Block};
+
+        /**
+         * Time budget of one execute loop iteration (queued commands, incoming dispatch and flush,
+         * waiting for events excluded). Overruns are logged as warnings and counted, 0 disables the check.
+         */
+        std::chrono::microseconds iteration_budget{10ms};
+
+        /**
+         * Time budget of handling one incoming message (router and subscribers), 0 disables the check
+         */
+        std::chrono::microseconds handler_budget{2ms};
+    };
+
+    struct DBusStats {
+        /**
+         * batch_sizes[i] - number of batches with size in range [2^i, 2^(i+1)), last bucket is open ended
+         */
+        std::array<uint64_t, 8> batch_sizes{};
+        uint64_t batches{0};
+        uint64_t commands{0};
+
+        size_t queue_depth{0};
+        size_t queue_high_water_mark{0};
+        uint64_t queue_rejected{0};
+        uint64_t queue_dropped{0};
+    };
+
+    /**
+     * Max number of messages kept in DBusStalls::worst
+     */
+    inline constexpr size_t max_stall_offenders{8};
+
+    /**
+     * Incoming message whose handler exceeded DBusConfig::handler_budget, durations in nanoseconds
+     */
+    struct DBusStall {
+        std::string path;
+        std::string iface;
+        std::string member;
+        uint64_t count{0};
+        uint64_t max_ns{0};
+        uint64_t last_ns{0};
+    };
+
+    struct DBusStalls {
+        // loop iterations over DBusConfig::iteration_budget
+        uint64_t iterations{0};
+        // handled messages over DBusConfig::handler_budget
+        uint64_t handlers{0};
+        // slowest first
+        std::vector<DBusStall> worst{};
+    };
+
+    /**
+     * Invoked on DBus thread once reply, error or timeout is received. Must not block.
+     * Exception: a call that can not be queued (DBus not running, queue full) fails on the calling thread,
+     * a call dropped by OverflowPolicy::DropOldest fails on the thread queueing the newer command.
+     */
+    using DBusReplyCallback = std::function<void(const DBusResult &result, std::shared_ptr<DBusMessage> reply)>;
+
     struct DBusData;
 
     class DBus {
     public:
-        explicit DBus(const std::shared_ptr<pie::Logger> &logger);
+        explicit DBus(const std::shared_ptr<pie::Logger> &logger, const DBusConfig &config = {});
 
         ~DBus();
 
@@ -61,17 +166,78 @@ namespace pie::dbus {
 
         [[nodiscard]] DBusState state() const;
 
+        /**
+         * Snapshot of DBus thread counters. Thread safe.
+         */
+        [[nodiscard]] DBusStats stats() const;
+
+        /**
+         * Snapshot of budget overruns. Thread safe.
+         */
+        [[nodiscard]] DBusStalls stalls() const;
+
+        /**
+         * Subscriber is offered every incoming message not handled by router
+         */
         void subscribe(const std::weak_ptr<pie::dbus::DBusOnMessage> &subscriber);
 
+        /**
+         * Routing table for incoming messages, consulted before subscribers
+         */
+        DBusRouter &router();
+
         std::tuple<DBusResult, std::shared_ptr<DBusMessage> > send_with_reply(
             std::shared_ptr<DBusMessage> &&msg,
             std::chrono::milliseconds max_wait_time = 25ms);
 
+        /**
+         * Send method call without blocking DBus thread. Returns immediately, any number of calls can be in flight.
+         * @param callback - invoked on DBus thread with the reply. If DBus is not running or the queue is full
+         * it is invoked with the error on the calling thread before call_async returns, so do not hold a lock
+         * the callback takes while calling.
+         * @param timeout - time to wait for the reply
+         */
+        void call_async(std::shared_ptr<DBusMessage> &&msg,
+                        DBusReplyCallback callback,
+                        std::chrono::milliseconds timeout = 25ms);
+
+        /**
+         * Same as call_async with callback, reply is delivered through future
+         */
+        std::future<std::tuple<DBusResult, std::shared_ptr<DBusMessage> > > call_async(
+            std::shared_ptr<DBusMessage> &&msg,
+            std::chrono::milliseconds timeout = 25ms);
+
         DBusResult send(std::shared_ptr<DBusMessage> &&msg,
                         std::chrono::milliseconds max_wait_time = 25ms);
 
         DBusResult reply(std::shared_ptr<DBusMessage> &&msg);
 
+        /**
+         * Read fd on DBus thread, e.g. socket handed to bluetoothd by AcquireWrite, so its packets
+         * skip DBus. Can be called only on DBus thread (e.g. from message handler).
+         * @param on_readable - invoked on DBus thread when fd is readable or closed by peer,
+         * returns false to remove the reader. Fd must stay open until then.
+         */
+        DBusResult add_reader(int fd, std::function<bool()> on_readable);
+
+        /**
+         * Poll fd for epoll events on DBus thread, e.g. AcquireNotify socket waiting for free space.
+         * Can be called only on DBus thread.
+         * @param on_ready - invoked on DBus thread with ready events, returns false to remove fd
+         */
+        DBusResult add_fd(int fd, uint32_t events, std::function<bool(uint32_t events)> on_ready);
+
+        /**
+         * Change events of fd added with add_fd or add_reader. Can be called only on DBus thread.
+         */
+        DBusResult modify_fd(int fd, uint32_t events);
+
+        /**
+         * Stop polling fd, its callback is destroyed. Can be called only on DBus thread.
+         */
+        DBusResult remove_fd(int fd);
+
         static std::shared_ptr<DBusMessage> new_message(std::string &bus_name, std::string &path, std::string &iface,
                                                         std::string &method);
 
@@ -7,24 +7,52 @@
 #include "DBusOnMessage.h"
 
 namespace pie::dbus {
-    std::ostream &operator<<(std::ostream &os, DBusMessageType type) {
+    const char *to_string(DBusMessageType type) {
         switch (type) {
             case DBusMessageType::Invalid:
-                return os << "Invalid";
+                return "Invalid";
             case DBusMessageType::MethodCall:
-                return os << "MethodCall";
+                return "MethodCall";
             case DBusMessageType::MethodReturn:
-                return os << "MethodReturn";
+                return "MethodReturn";
             case DBusMessageType::Signal:
-                return os << "Signal";
+                return "Signal";
             case DBusMessageType::Unknown:
-                return os << "Unknown";
+                return "Unknown";
         }
 
-        return os;
+        return "";
+    }
+
+    std::ostream &operator<<(std::ostream &os, DBusMessageType type) {
+        return os << to_string(type);
+    }
+
+    OwnedDBusMessageInfo DBusMessageInfo::to_owned() const {
+        return {
+            .type = type,
+            .destination = std::string{destination},
+            .path = std::string{path},
+            .iface = std::string{iface},
+            .member = std::string{member},
+            .serial = serial,
+            .reply_serial = reply_serial
+        };
+    }
+
+    DBusMessageInfo OwnedDBusMessageInfo::view() const {
+        return {
+            .type = type,
+            .destination = destination,
+            .path = path,
+            .iface = iface,
+            .member = member,
+            .serial = serial,
+            .reply_serial = reply_serial
+        };
     }
 
-    std::ostream &operator<<(std::ostream &os, DBusMessageInfo &info) {
+    std::ostream &operator<<(std::ostream &os, const DBusMessageInfo &info) {
         os << "{type: " << info.type;
         if (info.type != DBusMessageType::MethodReturn) {
             os << ", destination: " << info.destination;
@@ -9,6 +9,7 @@
 #include <dbus/dbus.h>
 
 #include <string>
+#include <string_view>
 #include <iostream>
 #include <memory>
 #include <optional>
@@ -22,9 +23,32 @@ namespace pie::dbus {
         Unknown = 100
     };
 
+    const char *to_string(DBusMessageType type);
+
     std::ostream &operator<<(std::ostream &os, DBusMessageType type);
 
+    struct OwnedDBusMessageInfo;
+
+    /**
+     * Header fields of a message. Strings are borrowed from the DBusMessage and are valid only
+     * while the message is alive, use to_owned() to keep them longer.
+     */
     struct DBusMessageInfo {
+        DBusMessageType type;
+        std::string_view destination;
+        std::string_view path;
+        std::string_view iface;
+        std::string_view member;
+        uint32_t serial{0};
+        std::optional<uint32_t> reply_serial{0};
+
+        [[nodiscard]] OwnedDBusMessageInfo to_owned() const;
+    };
+
+    /**
+     * Owning copy of DBusMessageInfo
+     */
+    struct OwnedDBusMessageInfo {
         DBusMessageType type;
         std::string destination;
         std::string path;
@@ -32,9 +56,11 @@ namespace pie::dbus {
         std::string member;
         uint32_t serial{0};
         std::optional<uint32_t> reply_serial{0};
+
+        [[nodiscard]] DBusMessageInfo view() const;
     };
 
-    std::ostream &operator<<(std::ostream &os, DBusMessageInfo &info);
+    std::ostream &operator<<(std::ostream &os, const DBusMessageInfo &info);
 
     class DBusOnMessage {
     public:
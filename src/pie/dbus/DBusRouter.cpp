@@ -0,0 +1,164 @@
+/**
+* @file DBusRouter.cpp
+* @author Ilija Poznic
+* @date 2025
+*/
+
+#include "DBusRouter.h"
+
+#include <unordered_map>
+
+namespace pie::dbus {
+    struct DBusRoute {
+        std::string path;
+        std::string iface;
+        std::string member;
+        DBusMessageHandler handler;
+    };
+
+    /**
+     * Keyed by precomputed hash, entries with colliding hashes are compared by strings
+     */
+    struct DBusRouterTable {
+        std::unordered_multimap<size_t, DBusRoute> methods{};
+        std::unordered_multimap<size_t, DBusRoute> objects{};
+        std::unordered_multimap<size_t, DBusRoute> subtrees{};
+    };
+}
+
+namespace {
+    size_t combine(size_t seed, size_t value) {
+        return seed ^ (value + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+    }
+
+    const pie::dbus::DBusMessageHandler *find(const std::unordered_multimap<size_t, pie::dbus::DBusRoute> &routes,
+                                              size_t hash, std::string_view path) {
+        auto [begin, end] = routes.equal_range(hash);
+        for (auto it = begin; it != end; ++it) {
+            if (it->second.path == path)
+                return &it->second.handler;
+        }
+
+        return nullptr;
+    }
+
+    /**
+     * "/a/b/c" -> "/a/b", "/a/b" -> "/a", "/a" -> "/", "/" -> ""
+     */
+    std::string_view parent(std::string_view path) {
+        if (path.size() <= 1)
+            return {};
+
+        auto pos = path.rfind('/');
+        if (pos == 0)
+            return path.substr(0, 1);
+
+        return path.substr(0, pos);
+    }
+
+    void erase_path(std::unordered_multimap<size_t, pie::dbus::DBusRoute> &routes, const std::string &path) {
+        for (auto it = routes.begin(); it != routes.end();) {
+            if (it->second.path == path)
+                it = routes.erase(it);
+            else
+                ++it;
+        }
+    }
+}
+
+namespace pie::dbus {
+    DBusRouter::DBusRouter() {
+        table = std::make_shared<const DBusRouterTable>();
+        cached_table = table;
+    }
+
+    DBusRouter::~DBusRouter() = default;
+
+    size_t DBusRouter::hash(std::string_view path, std::string_view iface, std::string_view member) {
+        std::hash<std::string_view> hasher{};
+        return combine(combine(hasher(path), hasher(iface)), hasher(member));
+    }
+
+    size_t DBusRouter::hash(std::string_view path) {
+        return std::hash<std::string_view>{}(path);
+    }
+
+    void DBusRouter::update(const std::function<void(DBusRouterTable &table)> &modify) {
+        std::lock_guard<std::mutex> locker(mutex);
+        auto new_table = std::make_shared<DBusRouterTable>(*std::atomic_load(&table));
+        modify(*new_table);
+        std::atomic_store(&table, std::shared_ptr<const DBusRouterTable>(std::move(new_table)));
+        version.fetch_add(1, std::memory_order_release);
+    }
+
+    void DBusRouter::add_method(const std::string &path, const std::string &iface, const std::string &member,
+                                DBusMessageHandler handler) {
+        update([&](DBusRouterTable &t) {
+            t.methods.emplace(hash(path, iface, member), DBusRoute{path, iface, member, std::move(handler)});
+        });
+    }
+
+    void DBusRouter::add_object(const std::string &path, DBusMessageHandler handler) {
+        update([&](DBusRouterTable &t) {
+            t.objects.emplace(hash(path), DBusRoute{path, {}, {}, std::move(handler)});
+        });
+    }
+
+    void DBusRouter::add_subtree(const std::string &path_prefix, DBusMessageHandler handler) {
+        update([&](DBusRouterTable &t) {
+            t.subtrees.emplace(hash(path_prefix), DBusRoute{path_prefix, {}, {}, std::move(handler)});
+        });
+    }
+
+    void DBusRouter::remove(const std::string &path) {
+        update([&](DBusRouterTable &t) {
+            erase_path(t.methods, path);
+            erase_path(t.objects, path);
+            erase_path(t.subtrees, path);
+        });
+    }
+
+    DBusHandlerResult DBusRouter::route(const DBusMessageInfo &msg_info, const std::shared_ptr<DBusMessage> &message) {
+        auto current_version = version.load(std::memory_order_acquire);
+        if (current_version != cached_version) {
+            cached_table = std::atomic_load(&table);
+            cached_version = current_version;
+        }
+
+        // cached_table is replaced only here, on DBus thread, so it stays valid during handler calls
+        const auto &routes = cached_table;
+        std::string_view path{msg_info.path};
+        if (path.empty())
+            return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+
+        auto [begin, end] = routes->methods.equal_range(hash(path, msg_info.iface, msg_info.member));
+        for (auto it = begin; it != end; ++it) {
+            const auto &route = it->second;
+            if (route.path == path && route.iface == msg_info.iface && route.member == msg_info.member) {
+                auto result = route.handler(msg_info, message);
+                if (result != DBUS_HANDLER_RESULT_NOT_YET_HANDLED)
+                    return result;
+            }
+        }
+
+        if (!routes->objects.empty()) {
+            if (auto handler = find(routes->objects, hash(path), path)) {
+                auto result = (*handler)(msg_info, message);
+                if (result != DBUS_HANDLER_RESULT_NOT_YET_HANDLED)
+                    return result;
+            }
+        }
+
+        if (!routes->subtrees.empty()) {
+            for (auto prefix = path; !prefix.empty(); prefix = parent(prefix)) {
+                if (auto handler = find(routes->subtrees, hash(prefix), prefix)) {
+                    auto result = (*handler)(msg_info, message);
+                    if (result != DBUS_HANDLER_RESULT_NOT_YET_HANDLED)
+                        return result;
+                }
+            }
+        }
+
+        return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+    }
+}
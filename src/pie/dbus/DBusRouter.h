@@ -0,0 +1,81 @@
+/**
+* @file DBusRouter.h
+* @author Ilija Poznic
+* @date 2025
+*/
+
+#pragma once
+
+#include "DBusOnMessage.h"
+
+#include <dbus/dbus.h>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+namespace pie::dbus {
+    using DBusMessageHandler = std::function<DBusHandlerResult(const DBusMessageInfo &msg_info,
+                                                               std::shared_ptr<DBusMessage> message)>;
+
+    struct DBusRouterTable;
+
+    /**
+     * Routes incoming messages to handlers registered on (path, interface, member), on object path
+     * or on path subtree. Lookup cost does not depend on number of registered objects.
+     *
+     * Order: exact (path, interface, member), object path, closest subtree prefix.
+     * Registration is thread safe (copy on write), route is called only from DBus thread.
+     */
+    class DBusRouter {
+    public:
+        DBusRouter();
+
+        ~DBusRouter();
+
+        DBusRouter(const DBusRouter &) = delete;
+
+        DBusRouter &operator=(const DBusRouter &) = delete;
+
+        void add_method(const std::string &path, const std::string &iface, const std::string &member,
+                        DBusMessageHandler handler);
+
+        /**
+         * Handler for any interface and member on path
+         */
+        void add_object(const std::string &path, DBusMessageHandler handler);
+
+        /**
+         * Handler for path and any path below it, used if there is no exact or object route
+         */
+        void add_subtree(const std::string &path_prefix, DBusMessageHandler handler);
+
+        /**
+         * Remove all routes registered on path (methods, object and subtree)
+         */
+        void remove(const std::string &path);
+
+        /**
+         * @return DBUS_HANDLER_RESULT_NOT_YET_HANDLED if there is no route or handler did not handle message
+         */
+        DBusHandlerResult route(const DBusMessageInfo &msg_info, const std::shared_ptr<DBusMessage> &message);
+
+        static size_t hash(std::string_view path, std::string_view iface, std::string_view member);
+
+        static size_t hash(std::string_view path);
+
+    private:
+        void update(const std::function<void(DBusRouterTable &table)> &modify);
+
+        std::mutex mutex{};
+        std::shared_ptr<const DBusRouterTable> table;
+        std::atomic<uint64_t> version{0};
+
+        // DBus thread cache of table, reloaded when version changes
+        std::shared_ptr<const DBusRouterTable> cached_table;
+        uint64_t cached_version{0};
+    };
+}
@@ -0,0 +1,391 @@
+/**
+* @file DBusEventLoop.cpp
+* @author Ilija Poznic
+* @date 2025
+*/
+
+#include "DBusEventLoop.h"
+#include "pie/dbus/DBusException.h"
+#include "pie/trace/Trace.h"
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+    enum class SourceKind {
+        Wakeup,
+        Watch,
+        Timeout,
+        Fd
+    };
+
+    /**
+     * Registered in epoll_event::data.ptr.
+     * libdbus can create separate read and write watch for the same fd, so all watches for one fd share a source
+     */
+    struct Source {
+        SourceKind kind;
+        int fd{-1};
+        std::vector<DBusWatch *> watches{};
+        DBusTimeout *timeout{nullptr};
+        // watch fd is in epoll only while some of its watches are enabled
+        bool polled{false};
+        bool removed{false};
+        std::function<bool(uint32_t events)> on_ready{};
+    };
+
+    constexpr size_t max_events = 16;
+}
+
+namespace pie::dbus {
+    struct DBusEventLoopData {
+        int epoll_fd{-1};
+        Source wakeup{SourceKind::Wakeup};
+        // eventfd is written only if no wakeup is pending, cleared when loop drains it
+        std::atomic<bool> wakeup_pending{false};
+        std::unordered_map<int, std::unique_ptr<Source> > watches{};
+        std::unordered_map<DBusTimeout *, std::unique_ptr<Source> > timeouts{};
+        std::unordered_map<int, std::unique_ptr<Source> > fds{};
+        // sources removed while handling events, freed at the end of run_once
+        std::vector<std::unique_ptr<Source> > retired{};
+    };
+}
+
+namespace {
+    uint32_t to_epoll_events(const Source &source) {
+        uint32_t events{0};
+        for (auto watch: source.watches) {
+            if (!dbus_watch_get_enabled(watch))
+                continue;
+
+            auto flags = dbus_watch_get_flags(watch);
+            if (flags & DBUS_WATCH_READABLE)
+                events |= EPOLLIN;
+
+            if (flags & DBUS_WATCH_WRITABLE)
+                events |= EPOLLOUT;
+        }
+
+        return events;
+    }
+
+    /**
+     * Sync epoll registration of watch fd with its enabled watches. epoll reports EPOLLHUP and EPOLLERR
+     * even with empty mask, so fd without enabled watch is removed from epoll, otherwise hung up connection
+     * would wake run_once with nothing to handle.
+     * @return false if epoll_ctl fails
+     */
+    bool update_watch(pie::dbus::DBusEventLoopData *data, int fd) {
+        auto it = data->watches.find(fd);
+        if (it == data->watches.end())
+            return true;
+
+        auto &source = it->second;
+        if (source->watches.empty()) {
+            if (source->polled)
+                epoll_ctl(data->epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+            source->removed = true;
+            data->retired.emplace_back(std::move(source));
+            data->watches.erase(it);
+            return true;
+        }
+
+        auto events = to_epoll_events(*source);
+        if (events == 0) {
+            if (source->polled)
+                epoll_ctl(data->epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+            source->polled = false;
+            return true;
+        }
+
+        epoll_event event{};
+        event.events = events;
+        event.data.ptr = source.get();
+        if (epoll_ctl(data->epoll_fd, source->polled ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, fd, &event) != 0)
+            return false;
+
+        source->polled = true;
+        return true;
+    }
+
+    dbus_bool_t add_watch(DBusWatch *watch, void *user_data) {
+        auto data = static_cast<pie::dbus::DBusEventLoopData *>(user_data);
+        auto fd = dbus_watch_get_unix_fd(watch);
+        auto it = data->watches.find(fd);
+        if (it == data->watches.end())
+            it = data->watches.emplace(fd, std::make_unique<Source>(Source{SourceKind::Watch, fd})).first;
+
+        auto &watches = it->second->watches;
+        watches.push_back(watch);
+        if (update_watch(data, fd))
+            return TRUE;
+
+        watches.pop_back();
+        if (watches.empty())
+            data->watches.erase(fd);
+        return FALSE;
+    }
+
+    void remove_watch(DBusWatch *watch, void *user_data) {
+        auto data = static_cast<pie::dbus::DBusEventLoopData *>(user_data);
+        for (auto &[fd, source]: data->watches) {
+            auto &watches = source->watches;
+            auto found = std::find(watches.begin(), watches.end(), watch);
+            if (found != watches.end()) {
+                watches.erase(found);
+                update_watch(data, fd);
+                return;
+            }
+        }
+    }
+
+    void toggle_watch(DBusWatch *watch, void *user_data) {
+        auto data = static_cast<pie::dbus::DBusEventLoopData *>(user_data);
+        update_watch(data, dbus_watch_get_unix_fd(watch));
+    }
+
+    void arm_timeout(const Source &source) {
+        itimerspec spec{};
+        if (dbus_timeout_get_enabled(source.timeout)) {
+            auto interval_ms = std::max(dbus_timeout_get_interval(source.timeout), 1);
+            spec.it_value.tv_sec = interval_ms / 1000;
+            spec.it_value.tv_nsec = static_cast<long>(interval_ms % 1000) * 1000000L;
+            spec.it_interval = spec.it_value;
+        }
+
+        timerfd_settime(source.fd, 0, &spec, nullptr);
+    }
+
+    dbus_bool_t add_timeout(DBusTimeout *timeout, void *user_data) {
+        auto data = static_cast<pie::dbus::DBusEventLoopData *>(user_data);
+        auto fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if (fd < 0)
+            return FALSE;
+
+        auto source = std::make_unique<Source>(Source{SourceKind::Timeout, fd});
+        source->timeout = timeout;
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.ptr = source.get();
+        if (epoll_ctl(data->epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            close(fd);
+            return FALSE;
+        }
+
+        arm_timeout(*source);
+        data->timeouts.emplace(timeout, std::move(source));
+        return TRUE;
+    }
+
+    void remove_timeout(DBusTimeout *timeout, void *user_data) {
+        auto data = static_cast<pie::dbus::DBusEventLoopData *>(user_data);
+        auto it = data->timeouts.find(timeout);
+        if (it == data->timeouts.end())
+            return;
+
+        epoll_ctl(data->epoll_fd, EPOLL_CTL_DEL, it->second->fd, nullptr);
+        close(it->second->fd);
+        it->second->removed = true;
+        data->retired.emplace_back(std::move(it->second));
+        data->timeouts.erase(it);
+    }
+
+    void toggle_timeout(DBusTimeout *timeout, void *user_data) {
+        auto data = static_cast<pie::dbus::DBusEventLoopData *>(user_data);
+        auto it = data->timeouts.find(timeout);
+        if (it != data->timeouts.end())
+            arm_timeout(*it->second);
+    }
+
+    bool is_registered(pie::dbus::DBusEventLoopData *data, int fd, DBusWatch *watch) {
+        auto it = data->watches.find(fd);
+        if (it == data->watches.end())
+            return false;
+
+        auto &watches = it->second->watches;
+        return std::find(watches.begin(), watches.end(), watch) != watches.end();
+    }
+
+    void handle_watches(pie::dbus::DBusEventLoopData *data, const Source &source, uint32_t events) {
+        // dbus_watch_handle can add or remove watches, iterate over copy.
+        // libdbus uses one read and one write watch per fd, copy them to stack to avoid allocation
+        auto fd = source.fd;
+        std::array<DBusWatch *, 4> stack_watches{};
+        std::vector<DBusWatch *> heap_watches{};
+        DBusWatch *const *watches = stack_watches.data();
+        auto watches_cnt = source.watches.size();
+        if (watches_cnt <= stack_watches.size()) {
+            std::copy(source.watches.begin(), source.watches.end(), stack_watches.begin());
+        } else {
+            heap_watches = source.watches;
+            watches = heap_watches.data();
+        }
+
+        for (size_t i = 0; i < watches_cnt; ++i) {
+            auto watch = watches[i];
+            if (!is_registered(data, fd, watch) || !dbus_watch_get_enabled(watch))
+                continue;
+
+            auto flags = dbus_watch_get_flags(watch);
+            unsigned int condition{0};
+            if ((events & EPOLLIN) && (flags & DBUS_WATCH_READABLE))
+                condition |= DBUS_WATCH_READABLE;
+
+            if ((events & EPOLLOUT) && (flags & DBUS_WATCH_WRITABLE))
+                condition |= DBUS_WATCH_WRITABLE;
+
+            if (events & EPOLLERR)
+                condition |= DBUS_WATCH_ERROR;
+
+            if (events & EPOLLHUP)
+                condition |= DBUS_WATCH_HANGUP;
+
+            if (condition != 0)
+                dbus_watch_handle(watch, condition);
+        }
+    }
+}
+
+namespace pie::dbus {
+    DBusEventLoop::DBusEventLoop() {
+        data = std::make_shared<DBusEventLoopData>();
+        data->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        if (data->epoll_fd < 0)
+            throw pie::dbus::DBusException(std::string("epoll_create1 failed: ") + strerror(errno));
+
+        data->wakeup.fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (data->wakeup.fd < 0) {
+            close(data->epoll_fd);
+            throw pie::dbus::DBusException(std::string("eventfd failed: ") + strerror(errno));
+        }
+
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.ptr = &data->wakeup;
+        epoll_ctl(data->epoll_fd, EPOLL_CTL_ADD, data->wakeup.fd, &event);
+    }
+
+    DBusEventLoop::~DBusEventLoop() {
+        for (auto &[timeout, source]: data->timeouts)
+            close(source->fd);
+
+        close(data->wakeup.fd);
+        close(data->epoll_fd);
+    }
+
+    bool DBusEventLoop::attach(DBusConnection *conn) {
+        auto p_data = data.get();
+        if (!dbus_connection_set_watch_functions(conn, add_watch, remove_watch, toggle_watch, p_data, nullptr))
+            return false;
+
+        return dbus_connection_set_timeout_functions(conn, add_timeout, remove_timeout, toggle_timeout, p_data,
+                                                     nullptr);
+    }
+
+    void DBusEventLoop::detach(DBusConnection *conn) {
+        dbus_connection_set_watch_functions(conn, nullptr, nullptr, nullptr, nullptr, nullptr);
+        dbus_connection_set_timeout_functions(conn, nullptr, nullptr, nullptr, nullptr, nullptr);
+    }
+
+    bool DBusEventLoop::add_fd(int fd, uint32_t events, std::function<bool(uint32_t events)> on_ready) {
+        if (data->fds.count(fd) != 0)
+            return false;
+
+        auto source = std::make_unique<Source>(Source{SourceKind::Fd, fd});
+        source->on_ready = std::move(on_ready);
+        epoll_event event{};
+        event.events = events;
+        event.data.ptr = source.get();
+        if (epoll_ctl(data->epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0)
+            return false;
+
+        data->fds.emplace(fd, std::move(source));
+        return true;
+    }
+
+    bool DBusEventLoop::modify_fd(int fd, uint32_t events) {
+        auto it = data->fds.find(fd);
+        if (it == data->fds.end())
+            return false;
+
+        epoll_event event{};
+        event.events = events;
+        event.data.ptr = it->second.get();
+        return epoll_ctl(data->epoll_fd, EPOLL_CTL_MOD, fd, &event) == 0;
+    }
+
+    void DBusEventLoop::remove_fd(int fd) {
+        auto it = data->fds.find(fd);
+        if (it == data->fds.end())
+            return;
+
+        epoll_ctl(data->epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+        it->second->removed = true;
+        data->retired.emplace_back(std::move(it->second));
+        data->fds.erase(it);
+    }
+
+    void DBusEventLoop::wakeup() {
+        if (data->wakeup_pending.exchange(true, std::memory_order_acq_rel))
+            return;
+
+        uint64_t value{1};
+        [[maybe_unused]] auto written = write(data->wakeup.fd, &value, sizeof(value));
+    }
+
+    void DBusEventLoop::run_once(int timeout_ms) {
+        std::array<epoll_event, max_events> events{};
+        int cnt{0};
+        {
+            PIE_TRACE_SCOPE("DBusEventLoop::wait");
+            cnt = epoll_wait(data->epoll_fd, events.data(), static_cast<int>(events.size()), timeout_ms);
+        }
+
+        for (auto i = 0; i < cnt; ++i) {
+            auto source = static_cast<Source *>(events[i].data.ptr);
+            if (source->removed)
+                continue;
+
+            switch (source->kind) {
+                case SourceKind::Wakeup: {
+                    uint64_t value{0};
+                    [[maybe_unused]] auto read_cnt = read(source->fd, &value, sizeof(value));
+                    // acquire pairs with wakeup, work queued before skipped writes is visible to caller
+                    data->wakeup_pending.exchange(false, std::memory_order_acq_rel);
+                    break;
+                }
+                case SourceKind::Watch: {
+                    PIE_TRACE_SCOPE("DBusEventLoop::read_write");
+                    handle_watches(data.get(), *source, events[i].events);
+                    break;
+                }
+                case SourceKind::Timeout: {
+                    uint64_t expirations{0};
+                    [[maybe_unused]] auto read_cnt = read(source->fd, &expirations, sizeof(expirations));
+                    PIE_TRACE_SCOPE("DBusEventLoop::timeout");
+                    dbus_timeout_handle(source->timeout);
+                    break;
+                }
+                case SourceKind::Fd: {
+                    PIE_TRACE_SCOPE("DBusEventLoop::fd");
+                    if (!source->on_ready(events[i].events))
+                        remove_fd(source->fd);
+                    break;
+                }
+            }
+        }
+
+        data->retired.clear();
+    }
+} // pie::dbus
@@ -0,0 +1,75 @@
+/**
+* @file DBusEventLoop.h
+* @author Ilija Poznic
+* @date 2025
+*/
+
+#pragma once
+
+#include <dbus/dbus.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+namespace pie::dbus {
+    struct DBusEventLoopData;
+
+    /**
+     * epoll based main loop for single DBusConnection.
+     * libdbus watches and timeouts are registered in epoll (timeouts as timerfd),
+     * eventfd is used to wake up loop from other threads. Other fds can be polled by the same loop with add_fd.
+     * Except wakeup(), all methods must be called from DBus thread.
+     */
+    class DBusEventLoop {
+    public:
+        /**
+         * @throw DBusException if epoll or eventfd can not be created
+         */
+        DBusEventLoop();
+
+        ~DBusEventLoop();
+
+        DBusEventLoop(const DBusEventLoop &) = delete;
+
+        DBusEventLoop &operator=(const DBusEventLoop &) = delete;
+
+        /**
+         * Register watch and timeout functions for connection
+         * @return false if not enough memory
+         */
+        bool attach(DBusConnection *conn);
+
+        void detach(DBusConnection *conn);
+
+        /**
+         * Call on_ready whenever fd has any of epoll events (EPOLLIN, EPOLLOUT), or an error or hang up, level triggered.
+         * The loop does not take ownership of fd, it must stay open until it is removed.
+         * @param on_ready - called with ready epoll events, returns false to remove fd, callback is destroyed with it
+         * @return false if fd is already registered or epoll_ctl fails
+         */
+        bool add_fd(int fd, uint32_t events, std::function<bool(uint32_t events)> on_ready);
+
+        /**
+         * Change epoll events of fd added with add_fd
+         */
+        bool modify_fd(int fd, uint32_t events);
+
+        void remove_fd(int fd);
+
+        /**
+         * Wake up thread blocked in run_once. Thread safe.
+         * Calls before the loop drains eventfd are coalesced into one write.
+         */
+        void wakeup();
+
+        /**
+         * Wait for IO, expired timeouts or wakeup and handle them
+         * @param timeout_ms - max time to wait, -1 to wait without limit
+         */
+        void run_once(int timeout_ms);
+
+    private:
+        std::shared_ptr<DBusEventLoopData> data;
+    };
+} // pie::dbus
@@ -6,31 +6,6 @@
 
 #include "DBusMessageExecuteBase.h"
 
-#include <mutex>
-#include <thread>
-
-namespace {
-    std::chrono::milliseconds wait_time = 1ms;
-
-
-    std::tuple<bool, std::unique_lock<std::shared_mutex> > lock(std::shared_mutex &mutex) {
-        auto cnt{0};
-        auto max_cnt{10};
-        while (cnt < max_cnt) {
-            try {
-                std::unique_lock<std::shared_mutex> lock(mutex);
-                return {true, std::move(lock)};
-            } catch (...) {
-            }
-            std::this_thread::sleep_for(wait_time);
-            ++cnt;
-        }
-
-        return {false, std::unique_lock<std::shared_mutex>()};
-    }
-}
-
-
 namespace pie::dbus {
     DBusMessageExecuteBase::DBusMessageExecuteBase(std::shared_ptr<DBusMessage> &&msg,
                                                    std::chrono::milliseconds max_wait_time) : msg(msg),
@@ -38,31 +13,42 @@ namespace pie::dbus {
     };
 
     DBusMessageExecuteBase::Status DBusMessageExecuteBase::status() {
-        auto [success, locker] = lock(mutex);
-        if (success)
-            return status_;
-
-        return DBusMessageExecuteBase::Status::New;;
+        std::lock_guard<std::mutex> locker(mutex);
+        return status_;
     }
 
     std::optional<std::tuple<DBusResult, std::shared_ptr<DBusMessage> > > DBusMessageExecuteBase::result() {
-        auto [success, locker] = lock(mutex);
-        if (success)
-            return result_;
+        std::lock_guard<std::mutex> locker(mutex);
+        return result_;
+    }
+
+    bool DBusMessageExecuteBase::wait_until(std::chrono::steady_clock::time_point deadline) {
+        std::unique_lock<std::mutex> locker(mutex);
+        return finished.wait_until(locker, deadline, [this] {
+            return status_ == Status::Finished;
+        });
+    }
 
-        return std::nullopt;
+    void DBusMessageExecuteBase::cancel(const DBusResult &result) {
+        finish(result, nullptr);
+    }
+
+    std::chrono::steady_clock::time_point DBusMessageExecuteBase::created() const {
+        return created_;
     }
 
     void DBusMessageExecuteBase::status(Status status) {
-        auto [success, locker] = lock(mutex);
-        if (success)
-            status_ = status;
+        std::lock_guard<std::mutex> locker(mutex);
+        status_ = status;
     }
 
+    void DBusMessageExecuteBase::finish(DBusResult result, std::shared_ptr<DBusMessage> msg) {
+        {
+            std::lock_guard<std::mutex> locker(mutex);
+            result_ = {std::move(result), std::move(msg)};
+            status_ = Status::Finished;
+        }
 
-    void DBusMessageExecuteBase::result(DBusResult result, std::shared_ptr<DBusMessage> msg) {
-        auto [success, locker] = lock(mutex);
-        if (success)
-            result_ = {result, msg};
+        finished.notify_all();
     }
 } // pie
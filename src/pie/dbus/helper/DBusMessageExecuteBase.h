@@ -13,11 +13,10 @@
 #include <memory>
 #include <tuple>
 #include <optional>
-#include <shared_mutex>
+#include <mutex>
+#include <condition_variable>
 #include <chrono>
 
-//std::chrono::milliseconds max_wait_time = 25ms;
-
 namespace pie::dbus {
     class DBusMessageExecuteBase {
     public:
@@ -38,19 +37,43 @@ namespace pie::dbus {
 
         std::optional<std::tuple<DBusResult, std::shared_ptr<DBusMessage> > > result();
 
+        /**
+         * Block caller until command is finished on DBus thread or deadline expires
+         * @param deadline - absolute point in time on steady clock
+         * @return true if command finished before deadline
+         */
+        bool wait_until(std::chrono::steady_clock::time_point deadline);
+
+        /**
+         * Finish command without executing it (e.g. dropped from full queue)
+         */
+        virtual void cancel(const DBusResult &result);
+
+        /**
+         * Point in time when command was created, i.e. just before it was queued
+         */
+        [[nodiscard]] std::chrono::steady_clock::time_point created() const;
+
     protected:
         void status(Status status);
 
-        void result(DBusResult result, std::shared_ptr<DBusMessage> msg);
+        /**
+         * Store result, mark command as finished and wake up waiting caller
+         */
+        void finish(DBusResult result, std::shared_ptr<DBusMessage> msg);
 
         Status status_{Status::New};
 
         std::optional<std::tuple<DBusResult, std::shared_ptr<DBusMessage> > > result_;
 
-        std::shared_mutex mutex{};
+        std::mutex mutex{};
+
+        std::condition_variable finished{};
 
         std::shared_ptr<DBusMessage> msg;
 
         std::chrono::milliseconds max_wait_time;
+
+        std::chrono::steady_clock::time_point created_{std::chrono::steady_clock::now()};
     };
 } // pie
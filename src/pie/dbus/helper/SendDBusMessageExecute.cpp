@@ -6,6 +6,8 @@
 
 #include "SendDBusMessageExecute.h"
 
+#include <pie/trace/Probe.h>
+
 namespace pie::dbus {
     SendDBusMessageExecute::SendDBusMessageExecute(std::shared_ptr<DBusMessage> &&msg)
         : DBusMessageExecuteBase(std::move(msg)) {
@@ -16,17 +18,15 @@ namespace pie::dbus {
         DBusError error{};
 
         uint32_t id{0};
+        // flushed by DBus::execute once per batch
         auto success = dbus_connection_send(conn, msg.get(), &id);
-        dbus_connection_flush(conn);
-        //dbus_connection_read_write_dispatch(conn, 1);
-
+        PIE_PROBE(dbus_send, dbus_message_get_path(msg.get()), id);
 
         auto dbus_result = pie::dbus::DBusResult{};
         if (!success) {
             dbus_result.code = DBusResultCode::Error;
             dbus_result.error = "Failed to send message";
         }
-        result(dbus_result, nullptr);
-        status(Status::Finished);
+        finish(dbus_result, nullptr);
     }
 } // pie
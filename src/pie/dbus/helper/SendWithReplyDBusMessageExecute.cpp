@@ -7,22 +7,81 @@
 #include "SendWithReplyDBusMessageExecute.h"
 
 #include "dbus.h"
+#include "dbus_metrics.h"
+
+#include <pie/trace/Probe.h>
+
+namespace {
+    using Self = std::shared_ptr<pie::dbus::SendWithReplyDBusMessageExecute>;
+
+    void free_self(void *user_data) {
+        delete static_cast<Self *>(user_data);
+    }
+}
 
 namespace pie::dbus {
     SendWithReplyDBusMessageExecute::SendWithReplyDBusMessageExecute(
-        std::shared_ptr<DBusMessage> &&msg) : DBusMessageExecuteBase(std::move(msg)) {
+        std::shared_ptr<DBusMessage> &&msg, std::chrono::milliseconds max_wait_time, DBusReplyCallback callback)
+        : DBusMessageExecuteBase(std::move(msg), max_wait_time), callback(std::move(callback)) {
     }
 
     void SendWithReplyDBusMessageExecute::exec(DBusConnection *conn) {
         status(Status::Running);
-        DBusError error{};
-        auto msg_rsp_p = dbus_connection_send_with_reply_and_block(conn, msg.get(), max_wait_time.count(), &error);
+        DBusPendingCall *pending{nullptr};
+        auto timeout_ms = static_cast<int>(max_wait_time.count());
+        sent = std::chrono::steady_clock::now();
+        if (!dbus_connection_send_with_reply(conn, msg.get(), &pending, timeout_ms) || !pending) {
+            complete({DBusResultCode::Error, "Failed to send message"}, nullptr);
+            return;
+        }
+
+        PIE_PROBE(dbus_send, dbus_message_get_path(msg.get()), dbus_message_get_serial(msg.get()));
+        // pending call keeps command alive until notified
+        auto self = new Self(shared_from_this());
+        if (!dbus_pending_call_set_notify(pending, on_pending_call_notify, self, free_self)) {
+            delete self;
+            dbus_pending_call_cancel(pending);
+            dbus_pending_call_unref(pending);
+            complete({DBusResultCode::Error, "Not enough memory"}, nullptr);
+            return;
+        }
+
+        dbus_pending_call_unref(pending);
+    }
+
+    void SendWithReplyDBusMessageExecute::cancel(const DBusResult &result) {
+        complete(result, nullptr);
+    }
+
+    void SendWithReplyDBusMessageExecute::on_pending_call_notify(DBusPendingCall *pending, void *user_data) {
+        auto &self = *static_cast<Self *>(user_data);
+        auto msg_rsp_p = dbus_pending_call_steal_reply(pending);
         std::shared_ptr<DBusMessage> msg_rsp(msg_rsp_p, [](DBusMessage *msg) {
             if (msg)
                 dbus_message_unref(msg);
         });
+
+        DBusError error{};
+        dbus_error_init(&error);
+        if (!msg_rsp_p)
+            dbus_set_error_const(&error, DBUS_ERROR_NO_REPLY, "No reply");
+        else
+            dbus_set_error_from_message(&error, msg_rsp_p);
+
         auto dbus_result = pie::dbus::parse(&error);
-        result(dbus_result, msg_rsp);
-        status(Status::Finished);
+        dbus_error_free(&error);
+
+        const auto &metrics = pie::dbus::dbus_metrics();
+        metrics.reply_latency.record(std::chrono::steady_clock::now() - self->sent);
+        if (dbus_result.code == DBusResultCode::E_CMD_Timeout)
+            metrics.reply_timeouts.add();
+
+        self->complete(dbus_result, msg_rsp);
+    }
+
+    void SendWithReplyDBusMessageExecute::complete(DBusResult result, std::shared_ptr<DBusMessage> msg_rsp) {
+        finish(result, msg_rsp);
+        if (callback)
+            callback(result, msg_rsp);
     }
 }
@@ -9,10 +9,28 @@
 #include "DBusMessageExecuteBase.h"
 
 namespace pie::dbus {
-    class SendWithReplyDBusMessageExecute : public DBusMessageExecuteBase {
+    /**
+     * Send method call with DBusPendingCall. exec never blocks DBus thread,
+     * command is finished from pending call notification (reply, error or timeout)
+     */
+    class SendWithReplyDBusMessageExecute : public DBusMessageExecuteBase,
+                                            public std::enable_shared_from_this<SendWithReplyDBusMessageExecute> {
     public:
-        explicit SendWithReplyDBusMessageExecute(std::shared_ptr<DBusMessage> &&msg);
+        explicit SendWithReplyDBusMessageExecute(std::shared_ptr<DBusMessage> &&msg,
+                                                 std::chrono::milliseconds max_wait_time = 25ms,
+                                                 DBusReplyCallback callback = nullptr);
 
         void exec(DBusConnection *conn) override;
+
+        void cancel(const DBusResult &result) override;
+
+    private:
+        static void on_pending_call_notify(DBusPendingCall *pending, void *user_data);
+
+        void complete(DBusResult result, std::shared_ptr<DBusMessage> msg_rsp);
+
+        DBusReplyCallback callback;
+
+        std::chrono::steady_clock::time_point sent{};
     };
 }
@@ -10,6 +10,30 @@
 #include <chrono>
 #include <sstream>
 #include <cstring>
+#include <utility>
+
+namespace {
+    /**
+     * Elements of "ay" argument, owned by the message
+     */
+    std::pair<const uint8_t *, size_t> get_fixed_bytes(DBusMessageIter *iter) {
+        if (dbus_message_iter_get_arg_type(iter) != DBUS_TYPE_ARRAY)
+            throw std::logic_error("it is not array");
+
+        DBusMessageIter arr_iter{nullptr};
+        dbus_message_iter_recurse(iter, &arr_iter);
+        auto type = dbus_message_iter_get_arg_type(&arr_iter);
+        // empty array has no element to check
+        if (type != DBUS_TYPE_BYTE && !(type == DBUS_TYPE_INVALID &&
+                                        dbus_message_iter_get_element_type(iter) == DBUS_TYPE_BYTE))
+            throw std::logic_error("it is not byte array");
+
+        const uint8_t *p{nullptr};
+        int cnt{0};
+        dbus_message_iter_get_fixed_array(&arr_iter, &p, &cnt);
+        return {p, static_cast<size_t>(cnt)};
+    }
+}
 
 namespace pie::dbus {
     pie::dbus::DBusResult parse(DBusError *error) {
@@ -18,7 +42,8 @@ namespace pie::dbus {
             ss << "error name: " << error->name;
             ss << ", message: " << error->message;
             if ((strcmp(error->name, DBUS_ERROR_TIMEOUT) == 0) ||
-                (strcmp(error->name, DBUS_ERROR_TIMED_OUT) == 0)) {
+                (strcmp(error->name, DBUS_ERROR_TIMED_OUT) == 0) ||
+                (strcmp(error->name, DBUS_ERROR_NO_REPLY) == 0)) {
                 return {
                     .code = pie::dbus::DBusResultCode::E_CMD_Timeout,
                     .error = ss.str()
@@ -34,8 +59,7 @@ namespace pie::dbus {
         return {};
     }
 
-    pie::dbus::DBusMessageInfo get_message_info(std::shared_ptr<DBusMessage> msg) {
-        auto msg_p = msg.get();
+    pie::dbus::DBusMessageInfo get_message_info(DBusMessage *msg_p) {
         auto msg_type = dbus_message_get_type(msg_p);
         pie::dbus::DBusMessageInfo msg_info{};
         msg_info.type = pie::dbus::message_get_type(msg_type);
@@ -64,6 +88,10 @@ namespace pie::dbus {
         return msg_info;
     }
 
+    pie::dbus::DBusMessageInfo get_message_info(const std::shared_ptr<DBusMessage> &msg) {
+        return get_message_info(msg.get());
+    }
+
     std::string get_message_info(const pie::dbus::DBusMessageInfo &msg_info) {
         std::stringstream ss;
         auto msg_type_as_string = pie::dbus::message_type_as_string(msg_info.type);
@@ -255,14 +283,30 @@ namespace pie::dbus {
         dbus_message_iter_open_container(&var_iter, DBUS_TYPE_ARRAY,
                                          DBUS_TYPE_BYTE_AS_STRING, &arr_iter);
 
+        // expects address of pointer to elements
+        auto p_values = values.data();
         dbus_message_iter_append_fixed_array(&arr_iter, DBUS_TYPE_BYTE,
-                                             values.data(), values.size());
+                                             &p_values, static_cast<int>(values.size()));
 
         dbus_message_iter_close_container(&var_iter, &arr_iter);
         dbus_message_iter_close_container(&dict_iter, &var_iter);
         dbus_message_iter_close_container(iter, &dict_iter);
     }
 
+    bool message_append_bytes(DBusMessageIter *iter, const uint8_t *data, size_t size) {
+        DBusMessageIter arr_iter{nullptr};
+        if (!dbus_message_iter_open_container(iter, DBUS_TYPE_ARRAY, DBUS_TYPE_BYTE_AS_STRING, &arr_iter))
+            return false;
+
+        // expects address of pointer to elements
+        if (!dbus_message_iter_append_fixed_array(&arr_iter, DBUS_TYPE_BYTE, &data, static_cast<int>(size))) {
+            dbus_message_iter_abandon_container(iter, &arr_iter);
+            return false;
+        }
+
+        return dbus_message_iter_close_container(iter, &arr_iter);
+    }
+
     void message_append_dict_entry_objects(DBusMessageIter *iter,
                                            const std::string &property_name,
                                            const std::vector<std::string> &objects) {
@@ -390,24 +434,13 @@ namespace pie::dbus {
     }
 
     std::vector<uint8_t> message_get_bytes(DBusMessageIter *iter) {
-        if (dbus_message_iter_get_arg_type(iter) != DBUS_TYPE_ARRAY)
-            throw std::logic_error("it is not array");
-
-        auto cnt = dbus_message_iter_get_element_count(iter);
-        DBusMessageIter arr_iter{nullptr};
-        dbus_message_iter_recurse(iter, &arr_iter);
-        auto type = dbus_message_iter_get_arg_type(&arr_iter);
-        if (type != DBUS_TYPE_BYTE)
-            throw std::logic_error("it is not byte array");
-
-        std::vector<uint8_t> bytes{};
-        uint8_t *p{nullptr};
-        dbus_message_iter_get_fixed_array(&arr_iter, &p, &cnt);
-        bytes.reserve(cnt);
-        for (size_t i = 0; i < cnt; i++)
-            bytes.push_back(p[i]);
+        auto [p, cnt] = get_fixed_bytes(iter);
+        return {p, p + cnt};
+    }
 
-        return bytes;
+    ByteView message_get_byte_view(DBusMessage *msg, DBusMessageIter *iter) {
+        auto [p, cnt] = get_fixed_bytes(iter);
+        return {msg, p, cnt};
     }
 
     void message_variant_iter_next(DBusMessageIter *iter) {
@@ -430,23 +463,29 @@ namespace pie::dbus {
             return msg_info.iface == pie::dbus::object_manager::iface;
         }
 
-        bool is_method(const pie::dbus::DBusMessageInfo &msg_info, const std::string &path, Methods method) {
-            std::string member;
-            switch (method) {
-                case Methods::GetManagedObject:
-                    member = "GetManagedObjects";
-                    break;
-                default:
-                    break;
+        namespace {
+            const char *member_name(Methods method) {
+                switch (method) {
+                    case Methods::GetManagedObject:
+                        return "GetManagedObjects";
+                    default:
+                        return "Unknown";
+                }
             }
+        }
 
+        std::string to_string(Methods method) {
+            return member_name(method);
+        }
+
+        bool is_method(const pie::dbus::DBusMessageInfo &msg_info, const std::string &path, Methods method) {
             return (msg_info.path == path &&
                     msg_info.iface == iface &&
-                    msg_info.member == member);
+                    msg_info.member == member_name(method));
         }
 
         bool is_signal(const pie::dbus::DBusMessageInfo &msg_info, const std::string &path, Signals signal) {
-            std::string member;
+            std::string_view member;
             switch (signal) {
                 case Signals::InterfacesAdded:
                     member = "InterfacesAdded";
@@ -468,25 +507,29 @@ namespace pie::dbus {
             return msg_info.iface == pie::dbus::properties::iface;
         }
 
-        bool is_method(const pie::dbus::DBusMessageInfo &msg_info, const std::string &path, Methods method) {
-            std::string member;
-            switch (method) {
-                case Methods::Get:
-                    member = "Get";
-                    break;
-                case Methods::Set:
-                    member = "Set";
-                    break;
-                case Methods::GetAll:
-                    member = "GetAll";;
-                    break;
-                default:
-                    break;
+        namespace {
+            const char *member_name(Methods method) {
+                switch (method) {
+                    case Methods::Get:
+                        return "Get";
+                    case Methods::Set:
+                        return "Set";
+                    case Methods::GetAll:
+                        return "GetAll";
+                    default:
+                        return "Unknown";
+                }
             }
+        }
+
+        std::string to_string(Methods method) {
+            return member_name(method);
+        }
 
+        bool is_method(const pie::dbus::DBusMessageInfo &msg_info, const std::string &path, Methods method) {
             return (msg_info.path == path &&
                     msg_info.iface == pie::dbus::properties::iface &&
-                    msg_info.member == member);
+                    msg_info.member == member_name(method));
         }
 
         // DBusMessage *message_new(const std::string &service, const std::string &path, Methods method) {
@@ -573,7 +616,7 @@ namespace pie::dbus {
         }
 
         bool is_signal(const pie::dbus::DBusMessageInfo &msg_info, const std::string &path, Signals signal) {
-            std::string member;
+            std::string_view member;
             switch (signal) {
                 case Signals::PropertiesChanged:
                     member = "PropertiesChanged";
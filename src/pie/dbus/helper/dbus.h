@@ -7,6 +7,7 @@
 #pragma once
 
 
+#include "pie/dbus/ByteView.h"
 #include "pie/dbus/DBus.h"
 #include "pie/dbus/DBusOnMessage.h"
 
@@ -32,7 +33,12 @@ namespace pie::dbus {
     //
     //                                                                   std::chrono::milliseconds timeout);
 
-    pie::dbus::DBusMessageInfo get_message_info(std::shared_ptr<DBusMessage> msg);
+    /**
+     * @return message header fields borrowed from msg, valid while msg is alive
+     */
+    pie::dbus::DBusMessageInfo get_message_info(DBusMessage *msg);
+
+    pie::dbus::DBusMessageInfo get_message_info(const std::shared_ptr<DBusMessage> &msg);
 
     std::string get_message_info(const pie::dbus::DBusMessageInfo &msg_info);
 
@@ -62,6 +68,12 @@ namespace pie::dbus {
     void message_append_dict_entry(DBusMessageIter *iter, const std::string &property_name,
                                    const std::vector<uint8_t> &values);
 
+    /**
+     * Append "ay" argument straight from data, no intermediate copy
+     * @return false if not enough memory
+     */
+    bool message_append_bytes(DBusMessageIter *iter, const uint8_t *data, size_t size);
+
     void message_append_dict_entry_objects(DBusMessageIter *iter,
                                            const std::string &property_name,
                                            const std::vector<std::string> &objects);
@@ -84,6 +96,12 @@ namespace pie::dbus {
 
     std::vector<uint8_t> message_get_bytes(DBusMessageIter *iter);
 
+    /**
+     * Same as message_get_bytes without copy, view references msg
+     * @param iter - iterator of msg at "ay" argument
+     */
+    ByteView message_get_byte_view(DBusMessage *msg, DBusMessageIter *iter);
+
     void message_variant_iter_next(DBusMessageIter *iter);
 
     bool is_match(const pie::dbus::DBusMessageInfo &msg_info,
@@ -104,6 +122,8 @@ namespace pie::dbus {
             InterfacesRemoved,
         };
 
+        std::string to_string(Methods method);
+
         bool is_method(const pie::dbus::DBusMessageInfo &msg_info, const std::string &path, Methods method);
 
         bool is_signal(const pie::dbus::DBusMessageInfo &msg_info, const std::string &path, Signals signal);
@@ -121,6 +141,8 @@ namespace pie::dbus {
             GetAll
         };
 
+        std::string to_string(Methods method);
+
         bool is_method(const pie::dbus::DBusMessageInfo &msg_info, const std::string &path, Methods method);
 
 
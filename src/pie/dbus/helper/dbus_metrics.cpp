@@ -0,0 +1,49 @@
+/**
+* @file dbus_metrics.cpp
+* @author Ilija Poznic
+* @date 2025
+*/
+
+#include "dbus_metrics.h"
+
+#include <dbus/dbus.h>
+
+#include <string>
+
+namespace {
+    inline const char *timeouts_help{"Method calls without reply (reply) and commands not finished (command) in time"};
+    inline const char *stalls_help{"Execute loop iterations (iteration) and message handlers (handler) over budget"};
+
+    pie::metrics::Counter *received_counter(int type) {
+        std::string labels{"type=\""};
+        labels += dbus_message_type_to_string(type);
+        labels += "\"";
+        return &pie::metrics::counter("dbus_messages_received_total", labels, "Incoming DBus messages by type");
+    }
+
+    pie::dbus::DBusMetrics make_metrics() {
+        pie::dbus::DBusMetrics metrics{
+            {},
+            pie::metrics::histogram("dbus_queue_wait_ns", {}, "Time command waited for DBus thread"),
+            pie::metrics::histogram("dbus_exec_ns", {}, "Time to execute command on DBus thread"),
+            pie::metrics::histogram("dbus_reply_latency_ns", {}, "Time from method call to reply"),
+            pie::metrics::counter("dbus_timeouts_total", "kind=\"reply\"", timeouts_help),
+            pie::metrics::counter("dbus_timeouts_total", "kind=\"command\"", timeouts_help),
+            pie::metrics::histogram("dbus_iteration_ns", {}, "Time of execute loop iteration without waiting"),
+            pie::metrics::counter("dbus_stalls_total", "kind=\"iteration\"", stalls_help),
+            pie::metrics::counter("dbus_stalls_total", "kind=\"handler\"", stalls_help),
+        };
+
+        for (int type = DBUS_MESSAGE_TYPE_INVALID; type <= DBUS_MESSAGE_TYPE_SIGNAL; ++type)
+            metrics.received[static_cast<size_t>(type)] = received_counter(type);
+
+        return metrics;
+    }
+}
+
+namespace pie::dbus {
+    const DBusMetrics &dbus_metrics() {
+        static const DBusMetrics metrics = make_metrics();
+        return metrics;
+    }
+}
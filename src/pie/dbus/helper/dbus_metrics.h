@@ -0,0 +1,40 @@
+/**
+* @file dbus_metrics.h
+* @author Ilija Poznic
+* @date 2025
+*/
+
+#pragma once
+
+#include <pie/metrics/Registry.h>
+
+#include <array>
+
+namespace pie::dbus {
+    /**
+     * Metrics of all DBus instances, durations are in nanoseconds
+     */
+    struct DBusMetrics {
+        /**
+         * Indexed by libdbus message type (DBUS_MESSAGE_TYPE_*)
+         */
+        std::array<pie::metrics::Counter *, 5> received{};
+
+        // enqueue -> exec start on DBus thread
+        pie::metrics::Histogram &queue_wait;
+        pie::metrics::Histogram &exec;
+        // method call sent -> reply, error or timeout received
+        pie::metrics::Histogram &reply_latency;
+        // method call sent, no reply before timeout
+        pie::metrics::Counter &reply_timeouts;
+        // caller stopped waiting for command (send, send_with_reply)
+        pie::metrics::Counter &command_timeouts;
+        // execute loop iteration without waiting for events
+        pie::metrics::Histogram &iteration;
+        // budget overruns, see DBusConfig::iteration_budget and handler_budget
+        pie::metrics::Counter &iteration_stalls;
+        pie::metrics::Counter &handler_stalls;
+    };
+
+    const DBusMetrics &dbus_metrics();
+}
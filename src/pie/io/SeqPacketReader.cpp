@@ -0,0 +1,105 @@
+/**
+* @file SeqPacketReader.cpp
+* @author Ilija Poznic
+* @date 2025
+*/
+
+#include "SeqPacketReader.h"
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <vector>
+
+namespace {
+    // buffers kept for reuse, more are allocated only while subscribers hold older packets
+    constexpr size_t max_pooled_buffers{4};
+
+    using Buffer = std::vector<uint8_t>;
+}
+
+namespace pie::io {
+    struct SeqPacketReaderData {
+        int fd{-1};
+        size_t max_packet_size{0};
+        std::vector<std::shared_ptr<Buffer> > pool{};
+        uint64_t packets{0};
+        uint64_t truncated{0};
+    };
+}
+
+namespace {
+    std::shared_ptr<Buffer> free_buffer(pie::io::SeqPacketReaderData &data) {
+        for (const auto &buffer: data.pool) {
+            if (buffer.use_count() == 1)
+                return buffer;
+        }
+
+        auto buffer = std::make_shared<Buffer>(data.max_packet_size);
+        if (data.pool.size() < max_pooled_buffers)
+            data.pool.push_back(buffer);
+
+        return buffer;
+    }
+
+    bool is_hung_up(int fd) {
+        pollfd poll_fd{fd, POLLIN, 0};
+        return poll(&poll_fd, 1, 0) > 0 && (poll_fd.revents & (POLLHUP | POLLERR)) != 0;
+    }
+}
+
+namespace pie::io {
+    SeqPacketReader::SeqPacketReader(int fd, size_t max_packet_size) {
+        data = std::make_shared<SeqPacketReaderData>();
+        data->fd = fd;
+        data->max_packet_size = max_packet_size == 0 ? 1 : max_packet_size;
+    }
+
+    SeqPacketReader::~SeqPacketReader() {
+        if (data->fd >= 0)
+            close(data->fd);
+    }
+
+    int SeqPacketReader::fd() const {
+        return data->fd;
+    }
+
+    bool SeqPacketReader::read(const OnPacket &on_packet, size_t max_packets) {
+        for (size_t i = 0; i < max_packets; ++i) {
+            auto buffer = free_buffer(*data);
+            // MSG_TRUNC returns real packet size
+            auto cnt = recv(data->fd, buffer->data(), buffer->size(), MSG_DONTWAIT | MSG_TRUNC);
+            if (cnt < 0) {
+                if (errno == EINTR)
+                    continue;
+
+                return errno == EAGAIN || errno == EWOULDBLOCK;
+            }
+
+            // 0 is returned for empty packet (write of empty value) and for closed peer
+            if (cnt == 0 && is_hung_up(data->fd))
+                return false;
+
+            auto size = static_cast<size_t>(cnt);
+            if (size > buffer->size()) {
+                ++data->truncated;
+                size = buffer->size();
+            }
+
+            ++data->packets;
+            on_packet(pie::dbus::ByteView{buffer, buffer->data(), size});
+        }
+
+        return true;
+    }
+
+    uint64_t SeqPacketReader::packets() const {
+        return data->packets;
+    }
+
+    uint64_t SeqPacketReader::truncated() const {
+        return data->truncated;
+    }
+} // pie::io
@@ -0,0 +1,56 @@
+/**
+* @file SeqPacketReader.h
+* @author Ilija Poznic
+* @date 2025
+*/
+
+#pragma once
+
+#include "pie/dbus/ByteView.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+namespace pie::io {
+    struct SeqPacketReaderData;
+
+    /**
+     * Non blocking reader of SOCK_SEQPACKET socket, one packet per recv.
+     * Packets are read into pooled buffers and passed as ByteView, a buffer is reused once no view
+     * references it, so keeping last packet costs one extra buffer and no copy.
+     * Not thread safe, used from thread polling the fd (e.g. DBus thread, see DBus::add_reader).
+     */
+    class SeqPacketReader {
+    public:
+        using OnPacket = std::function<void(const pie::dbus::ByteView &packet)>;
+
+        /**
+         * @param fd - non blocking socket, owned by reader and closed in destructor
+         * @param max_packet_size - larger packets are truncated and counted by truncated()
+         */
+        SeqPacketReader(int fd, size_t max_packet_size);
+
+        ~SeqPacketReader();
+
+        SeqPacketReader(const SeqPacketReader &) = delete;
+
+        SeqPacketReader &operator=(const SeqPacketReader &) = delete;
+
+        [[nodiscard]] int fd() const;
+
+        /**
+         * Read pending packets, at most max_packets, so other fds of the same loop are not starved
+         * @return false if peer closed the socket or recv failed
+         */
+        bool read(const OnPacket &on_packet, size_t max_packets);
+
+        [[nodiscard]] uint64_t packets() const;
+
+        [[nodiscard]] uint64_t truncated() const;
+
+    private:
+        std::shared_ptr<SeqPacketReaderData> data;
+    };
+} // pie::io
@@ -0,0 +1,176 @@
+/**
+* @file SeqPacketWriter.cpp
+* @author Ilija Poznic
+* @date 2025
+*/
+
+#include "SeqPacketWriter.h"
+#include "pie/concurrent/RingBuffer.h"
+
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <system_error>
+#include <vector>
+
+namespace {
+    // packets per sendmmsg call
+    constexpr size_t max_batch{64};
+
+    // slot capacity grows to the largest packet and is kept, packets are swapped between ring and batch
+    using Packet = std::vector<uint8_t>;
+}
+
+namespace pie::io {
+    struct SeqPacketWriterData {
+        explicit SeqPacketWriterData(size_t capacity) : ring(capacity) {
+        }
+
+        int fd{-1};
+        int wakeup_fd{-1};
+        size_t max_packet_size{0};
+        pie::concurrent::RingBuffer<Packet> ring;
+        std::atomic<bool> wakeup_pending{false};
+
+        // popped from ring and not sent yet, used only by consumer
+        std::array<Packet, max_batch> batch{};
+        size_t batch_begin{0};
+        size_t batch_end{0};
+
+        std::atomic<uint64_t> sent{0};
+        std::atomic<uint64_t> overflows{0};
+    };
+}
+
+namespace {
+    void signal_wakeup(pie::io::SeqPacketWriterData &data) {
+        if (data.wakeup_pending.exchange(true, std::memory_order_acq_rel))
+            return;
+
+        uint64_t value{1};
+        [[maybe_unused]] auto written = write(data.wakeup_fd, &value, sizeof(value));
+    }
+
+    void clear_wakeup(pie::io::SeqPacketWriterData &data) {
+        uint64_t value{0};
+        [[maybe_unused]] auto read_cnt = read(data.wakeup_fd, &value, sizeof(value));
+        data.wakeup_pending.store(false, std::memory_order_release);
+    }
+
+    /**
+     * @return number of packets in batch
+     */
+    size_t fill_batch(pie::io::SeqPacketWriterData &data, size_t max_packets) {
+        if (data.batch_begin != data.batch_end)
+            return data.batch_end - data.batch_begin;
+
+        size_t cnt{0};
+        data.ring.pop_all([&data, &cnt](Packet &packet) {
+            data.batch[cnt++].swap(packet);
+        }, std::min(max_batch, max_packets));
+        data.batch_begin = 0;
+        data.batch_end = cnt;
+        return cnt;
+    }
+}
+
+namespace pie::io {
+    SeqPacketWriter::SeqPacketWriter(int fd, size_t max_packet_size, size_t capacity) {
+        data = std::make_shared<SeqPacketWriterData>(capacity);
+        data->fd = fd;
+        data->max_packet_size = max_packet_size;
+        data->wakeup_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (data->wakeup_fd < 0) {
+            auto error = errno;
+            close(fd);
+            throw std::system_error(error, std::generic_category(), "eventfd failed");
+        }
+    }
+
+    SeqPacketWriter::~SeqPacketWriter() {
+        close(data->wakeup_fd);
+        if (data->fd >= 0)
+            close(data->fd);
+    }
+
+    int SeqPacketWriter::fd() const {
+        return data->fd;
+    }
+
+    int SeqPacketWriter::wakeup_fd() const {
+        return data->wakeup_fd;
+    }
+
+    size_t SeqPacketWriter::max_packet_size() const {
+        return data->max_packet_size;
+    }
+
+    PushResult SeqPacketWriter::push(const uint8_t *bytes, size_t size) {
+        if (size > data->max_packet_size)
+            return PushResult::TooLarge;
+
+        if (!data->ring.try_push([bytes, size](Packet &packet) {
+            packet.assign(bytes, bytes + size);
+        })) {
+            data->overflows.fetch_add(1, std::memory_order_relaxed);
+            return PushResult::Full;
+        }
+
+        signal_wakeup(*data);
+        return PushResult::Queued;
+    }
+
+    FlushResult SeqPacketWriter::flush(size_t max_packets) {
+        // cleared before queue is read, packet pushed from now on signals again
+        clear_wakeup(*data);
+
+        std::array<mmsghdr, max_batch> msgs{};
+        std::array<iovec, max_batch> iovs{};
+        size_t flushed{0};
+        while (flushed < max_packets) {
+            auto cnt = fill_batch(*data, max_packets - flushed);
+            if (cnt == 0)
+                return FlushResult::Drained;
+
+            for (size_t i = 0; i < cnt; ++i) {
+                auto &packet = data->batch[data->batch_begin + i];
+                iovs[i].iov_base = packet.data();
+                iovs[i].iov_len = packet.size();
+                msgs[i].msg_hdr = {};
+                msgs[i].msg_hdr.msg_iov = &iovs[i];
+                msgs[i].msg_hdr.msg_iovlen = 1;
+            }
+
+            auto sent = sendmmsg(data->fd, msgs.data(), static_cast<unsigned int>(cnt), MSG_DONTWAIT | MSG_NOSIGNAL);
+            if (sent < 0) {
+                if (errno == EINTR)
+                    continue;
+
+                return errno == EAGAIN || errno == EWOULDBLOCK ? FlushResult::Blocked : FlushResult::Closed;
+            }
+
+            data->batch_begin += static_cast<size_t>(sent);
+            data->sent.fetch_add(static_cast<uint64_t>(sent), std::memory_order_relaxed);
+            flushed += static_cast<size_t>(sent);
+        }
+
+        if (data->batch_begin == data->batch_end && data->ring.empty())
+            return FlushResult::Drained;
+
+        signal_wakeup(*data);
+        return FlushResult::Pending;
+    }
+
+    uint64_t SeqPacketWriter::sent() const {
+        return data->sent.load(std::memory_order_relaxed);
+    }
+
+    uint64_t SeqPacketWriter::overflows() const {
+        return data->overflows.load(std::memory_order_relaxed);
+    }
+} // pie::io
@@ -0,0 +1,87 @@
+/**
+* @file SeqPacketWriter.h
+* @author Ilija Poznic
+* @date 2025
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace pie::io {
+    enum class PushResult {
+        Queued,
+        Full,
+        TooLarge
+    };
+
+    enum class FlushResult {
+        // queue is empty
+        Drained,
+        // max_packets sent and more are queued, wakeup_fd() is signalled again
+        Pending,
+        // socket is full, flush again once it is writable
+        Blocked,
+        // peer closed the socket or send failed
+        Closed
+    };
+
+    struct SeqPacketWriterData;
+
+    /**
+     * Packet queue in front of SOCK_SEQPACKET socket. Any thread pushes packets into a lock-free ring,
+     * single consumer thread sends them with sendmmsg, up to max_batch packets per syscall.
+     * writev is not used as it would join the batch into one packet.
+     * Producers signal wakeup_fd() when queue becomes non empty, consumer polls it and calls flush.
+     */
+    class SeqPacketWriter {
+    public:
+        /**
+         * @param fd - non blocking socket, owned by writer and closed in destructor
+         * @param max_packet_size - e.g. ATT_MTU - 3 for notifications, larger packets are rejected
+         * @param capacity - queued packets, rounded up to power of two
+         * @throw std::system_error if wakeup eventfd can not be created, fd is closed
+         */
+        SeqPacketWriter(int fd, size_t max_packet_size, size_t capacity);
+
+        ~SeqPacketWriter();
+
+        SeqPacketWriter(const SeqPacketWriter &) = delete;
+
+        SeqPacketWriter &operator=(const SeqPacketWriter &) = delete;
+
+        [[nodiscard]] int fd() const;
+
+        /**
+         * eventfd readable while queued packets wait for flush
+         */
+        [[nodiscard]] int wakeup_fd() const;
+
+        [[nodiscard]] size_t max_packet_size() const;
+
+        /**
+         * Copy packet to queue. Thread safe, lock-free.
+         */
+        PushResult push(const uint8_t *data, size_t size);
+
+        /**
+         * Send queued packets, at most max_packets. Only from consumer thread.
+         */
+        FlushResult flush(size_t max_packets);
+
+        /**
+         * Packets sent to socket
+         */
+        [[nodiscard]] uint64_t sent() const;
+
+        /**
+         * Packets rejected by push because queue was full
+         */
+        [[nodiscard]] uint64_t overflows() const;
+
+    private:
+        std::shared_ptr<SeqPacketWriterData> data;
+    };
+} // pie::io
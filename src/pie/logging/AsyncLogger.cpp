@@ -0,0 +1,240 @@
+/**
+* @file AsyncLogger.cpp
+* @author Ilija Poznic
+* @date 2025
+*/
+
+#include "AsyncLogger.h"
+#include "ConsoleLogger_ostream_helper.h"
+#include "pie/concurrent/RingBuffer.h"
+#include "pie/trace/Trace.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+    constexpr size_t max_batch{256};
+    // writer with empty ring sleeps until first record, then waits this long for a batch to fill,
+    // producers cut the wait short if backlog grows or for warnings and errors
+    constexpr std::chrono::milliseconds writer_interval{10};
+    constexpr size_t record_text_size{240};
+
+    struct LogRecord {
+        pie::LogLevel level{pie::LogLevel::Trace};
+        uint16_t size{0};
+        std::array<char, record_text_size> text{};
+    };
+}
+
+namespace pie::logging {
+    struct AsyncLoggerData {
+        explicit AsyncLoggerData(const AsyncLoggerConfig &config)
+            : ring(config.capacity), policy(config.policy) {
+        }
+
+        pie::concurrent::RingBuffer<LogRecord> ring;
+        AsyncLoggerPolicy policy;
+        FILE *out{stdout};
+        bool own_out{false};
+        std::thread writer_thread;
+        std::atomic<bool> running{true};
+
+        std::atomic<uint64_t> pushed{0};
+        std::atomic<uint64_t> written{0};
+        std::atomic<uint64_t> dropped{0};
+        std::atomic<uint64_t> truncated{0};
+
+        // producers take mutex only if writer is waiting: idle (ring empty, no timeout)
+        // or filling a batch (until writer_interval or urgent)
+        std::atomic<bool> writer_waiting{false};
+        std::atomic<bool> writer_idle{false};
+        std::atomic<bool> urgent{false};
+        std::atomic<uint32_t> producers_waiting{0};
+        std::mutex mutex{};
+        std::condition_variable writer_cv{};
+        std::condition_variable space_cv{};
+    };
+}
+
+namespace {
+    /**
+     * Ask writer to write pending records now
+     */
+    void wake_writer(pie::logging::AsyncLoggerData &data) {
+        data.urgent.store(true, std::memory_order_relaxed);
+        // pairs with fence in writer, either writer sees urgent flag or producer sees waiting flag
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (data.writer_waiting.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> locker(data.mutex);
+            data.writer_cv.notify_one();
+        }
+    }
+
+    /**
+     * Start writer sleeping on empty ring, record must be already pushed
+     */
+    void wake_idle_writer(pie::logging::AsyncLoggerData &data) {
+        // pairs with fence in writer, either writer sees the record or producer sees idle flag
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (data.writer_idle.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> locker(data.mutex);
+            data.writer_cv.notify_one();
+        }
+    }
+
+    void append(std::string &batch, const LogRecord &record) {
+        batch.append(to_short_string(record.level));
+        batch.append(" | ");
+        batch.append(record.text.data(), record.size);
+        batch.push_back('\n');
+    }
+
+    void write_batches(pie::logging::AsyncLoggerData &data) {
+        PIE_TRACE_THREAD_NAME("AsyncLogger");
+        std::string batch{};
+        std::string errors{};
+        batch.reserve(max_batch * (record_text_size + 8));
+        while (true) {
+            batch.clear();
+            errors.clear();
+            auto cnt = data.ring.pop_all([&](LogRecord &record) {
+                append(batch, record);
+                if (record.level == pie::LogLevel::Error && data.out == stdout)
+                    append(errors, record);
+            }, max_batch);
+
+            if (cnt > 0) {
+                std::fwrite(batch.data(), 1, batch.size(), data.out);
+                std::fflush(data.out);
+                if (!errors.empty())
+                    std::fwrite(errors.data(), 1, errors.size(), stderr);
+
+                data.written.fetch_add(cnt, std::memory_order_release);
+                if (data.producers_waiting.load(std::memory_order_relaxed) > 0) {
+                    std::lock_guard<std::mutex> locker(data.mutex);
+                    data.space_cv.notify_all();
+                }
+
+                continue;
+            }
+
+            if (!data.running.load(std::memory_order_acquire) && data.ring.empty())
+                break;
+
+            std::unique_lock<std::mutex> locker(data.mutex);
+            // empty ring, no wakeups until a record arrives
+            data.writer_idle.store(true, std::memory_order_relaxed);
+            data.writer_waiting.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            data.writer_cv.wait(locker, [&data] {
+                return !data.ring.empty() || !data.running.load(std::memory_order_acquire);
+            });
+            data.writer_idle.store(false, std::memory_order_relaxed);
+
+            // first record of a burst, let the batch fill unless producer asks for write
+            data.writer_cv.wait_for(locker, writer_interval, [&data] {
+                return data.urgent.load(std::memory_order_relaxed) || !data.running.load(std::memory_order_acquire);
+            });
+            data.writer_waiting.store(false, std::memory_order_relaxed);
+            data.urgent.store(false, std::memory_order_relaxed);
+        }
+    }
+}
+
+namespace pie::logging {
+    AsyncLogger::AsyncLogger(const AsyncLoggerConfig &config) {
+        data = std::make_shared<AsyncLoggerData>(config);
+        if (!config.file.empty()) {
+            data->out = std::fopen(config.file.c_str(), "a");
+            if (!data->out)
+                throw std::runtime_error("Failed to open log file: " + config.file);
+
+            data->own_out = true;
+        }
+
+        data->writer_thread = std::thread([p_data = data.get()] {
+            write_batches(*p_data);
+        });
+    }
+
+    AsyncLogger::~AsyncLogger() {
+        data->running.store(false, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> locker(data->mutex);
+            data->writer_cv.notify_one();
+        }
+
+        if (data->writer_thread.joinable())
+            data->writer_thread.join();
+
+        if (data->own_out)
+            std::fclose(data->out);
+    }
+
+    void AsyncLogger::log(LogLevel level, std::string message) {
+        if (!is_enabled(level))
+            return;
+
+        auto fill = [&](LogRecord &record) {
+            auto size = std::min(message.size(), record.text.size());
+            std::memcpy(record.text.data(), message.data(), size);
+            record.size = static_cast<uint16_t>(size);
+            record.level = level;
+        };
+
+        while (!data->ring.try_push(fill)) {
+            if (data->policy == AsyncLoggerPolicy::Drop) {
+                data->dropped.fetch_add(1, std::memory_order_relaxed);
+                wake_writer(*data);
+                return;
+            }
+
+            wake_writer(*data);
+            std::unique_lock<std::mutex> locker(data->mutex);
+            data->producers_waiting.fetch_add(1, std::memory_order_relaxed);
+            data->space_cv.wait_for(locker, std::chrono::milliseconds(1));
+            data->producers_waiting.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        if (message.size() > record_text_size)
+            data->truncated.fetch_add(1, std::memory_order_relaxed);
+
+        auto backlog = data->pushed.fetch_add(1, std::memory_order_relaxed) + 1 -
+                       data->written.load(std::memory_order_relaxed);
+        if (backlog >= data->ring.capacity() / 4 || level >= LogLevel::Warning)
+            wake_writer(*data);
+        else
+            wake_idle_writer(*data);
+    }
+
+    void AsyncLogger::flush() {
+        auto target = data->pushed.load(std::memory_order_relaxed);
+        while (data->written.load(std::memory_order_acquire) < target) {
+            wake_writer(*data);
+            std::unique_lock<std::mutex> locker(data->mutex);
+            data->producers_waiting.fetch_add(1, std::memory_order_relaxed);
+            data->space_cv.wait_for(locker, std::chrono::milliseconds(1));
+            data->producers_waiting.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    uint64_t AsyncLogger::written() const {
+        return data->written.load(std::memory_order_relaxed);
+    }
+
+    uint64_t AsyncLogger::dropped() const {
+        return data->dropped.load(std::memory_order_relaxed);
+    }
+
+    uint64_t AsyncLogger::truncated() const {
+        return data->truncated.load(std::memory_order_relaxed);
+    }
+}
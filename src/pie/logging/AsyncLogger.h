@@ -0,0 +1,64 @@
+/**
+* @file AsyncLogger.h
+* @author Ilija Poznic
+* @date 2025
+*/
+
+#pragma once
+#include "Logger.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace pie::logging {
+    enum class AsyncLoggerPolicy {
+        // record is discarded and counted in dropped()
+        Drop,
+        // caller waits for writer thread to free a slot
+        Block
+    };
+
+    struct AsyncLoggerConfig {
+        // number of preallocated records
+        size_t capacity{4096};
+        AsyncLoggerPolicy policy{AsyncLoggerPolicy::Drop};
+        // log file (appended), stdout if empty
+        std::string file{};
+    };
+
+    struct AsyncLoggerData;
+
+    /**
+     * Logger which copies message to preallocated lock-free ring and returns. Background thread
+     * writes records in batches, one write and flush per batch.
+     * Messages longer than record size are truncated and counted in truncated().
+     */
+    class AsyncLogger : public Logger {
+    public:
+        explicit AsyncLogger(const AsyncLoggerConfig &config = {});
+
+        ~AsyncLogger() override;
+
+        AsyncLogger(const AsyncLogger &) = delete;
+
+        AsyncLogger &operator=(const AsyncLogger &) = delete;
+
+        void log(LogLevel level, std::string message) override;
+
+        /**
+         * Block until all records logged before the call are written
+         */
+        void flush();
+
+        [[nodiscard]] uint64_t written() const;
+
+        [[nodiscard]] uint64_t dropped() const;
+
+        [[nodiscard]] uint64_t truncated() const;
+
+    private:
+        std::shared_ptr<AsyncLoggerData> data;
+    };
+}
@@ -0,0 +1,208 @@
+/**
+* @file BinaryLogger.cpp
+* @author Ilija Poznic
+* @date 2025
+*/
+
+#include "BinaryLogger.h"
+#include "binary_log_format.h"
+#include "LogTag.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+
+namespace pie::logging {
+    struct BinaryLoggerData {
+        int fd{-1};
+        uint8_t *mapped{nullptr};
+        size_t mapped_size{0};
+        binary_log::FileHeader *header{nullptr};
+        uint8_t *data{nullptr};
+
+        // formats 1..synced_formats are in formats table
+        std::atomic<uint16_t> synced_formats{0};
+        std::mutex formats_mutex{};
+        std::atomic<uint64_t> dropped{0};
+    };
+}
+
+namespace {
+    const pie::logging::LogFormat &text_format() {
+        static const auto &format = pie::logging::register_format(pie::logging::register_tag(""), "{}");
+        return format;
+    }
+
+    uint32_t thread_id() {
+        static thread_local auto id = static_cast<uint32_t>(syscall(SYS_gettid));
+        return id;
+    }
+
+    uint64_t timestamp_ns() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+    }
+
+    // header fields are shared with decoder through the file, accessed with atomic builtins
+    uint64_t load_acquire(const uint64_t &value) {
+        return __atomic_load_n(&value, __ATOMIC_ACQUIRE);
+    }
+
+    void store_release(uint64_t &value, uint64_t new_value) {
+        __atomic_store_n(&value, new_value, __ATOMIC_RELEASE);
+    }
+
+    /**
+     * Copy formats registered up to id to formats table
+     * @return false if table is full
+     */
+    bool sync_formats(pie::logging::BinaryLoggerData &data, uint16_t id) {
+        if (data.synced_formats.load(std::memory_order_acquire) >= id)
+            return true;
+
+        std::lock_guard<std::mutex> locker(data.formats_mutex);
+        auto header = data.header;
+        auto synced = data.synced_formats.load(std::memory_order_relaxed);
+        auto used = header->formats_size;
+        while (synced < id) {
+            const auto &format = pie::logging::format_by_id(synced + 1);
+            const auto &tag = format.tag->name();
+            auto entry_size = pie::logging::binary_log::align8(
+                sizeof(pie::logging::binary_log::FormatEntry) + tag.size() + format.format.size());
+            if (used + entry_size > header->formats_capacity)
+                return false;
+
+            auto p_entry = data.mapped + header->formats_offset + used;
+            pie::logging::binary_log::FormatEntry entry{
+                format.id,
+                static_cast<uint16_t>(tag.size()),
+                static_cast<uint16_t>(format.format.size()),
+                0
+            };
+            std::memcpy(p_entry, &entry, sizeof(entry));
+            std::memcpy(p_entry + sizeof(entry), tag.data(), tag.size());
+            std::memcpy(p_entry + sizeof(entry) + tag.size(), format.format.data(), format.format.size());
+            used += entry_size;
+            store_release(header->formats_size, used);
+            ++synced;
+            data.synced_formats.store(synced, std::memory_order_release);
+        }
+
+        return true;
+    }
+
+    pie::logging::binary_log::RecordHeader *record_at(pie::logging::BinaryLoggerData &data, uint64_t slot) {
+        auto offset = (slot % data.header->data_slots) * pie::logging::binary_log::slot_size;
+        return reinterpret_cast<pie::logging::binary_log::RecordHeader *>(data.data + offset);
+    }
+
+    void write_record(pie::logging::BinaryLoggerData &data, pie::LogLevel level, uint16_t format_id,
+                      const uint8_t *args, size_t size) {
+        auto header = data.header;
+        auto data_slots = header->data_slots;
+        auto slots = pie::logging::binary_log::record_slots(size);
+
+        // reserve slots, record does not wrap, skip to start of ring if it does not fit at the end
+        uint64_t pos = load_acquire(header->write_slot);
+        uint64_t start{0};
+        do {
+            auto index = pos % data_slots;
+            start = index + slots > data_slots ? pos + (data_slots - index) : pos;
+        } while (!__atomic_compare_exchange_n(&header->write_slot, &pos, start + slots, true,
+                                              __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+
+        if (start != pos) {
+            auto padding = record_at(data, pos);
+            padding->format_id = pie::logging::binary_log::padding_format_id;
+            padding->size = 0;
+            store_release(padding->slot, pos);
+        }
+
+        auto record = record_at(data, start);
+        record->timestamp_ns = timestamp_ns();
+        record->thread_id = thread_id();
+        record->format_id = format_id;
+        record->size = static_cast<uint16_t>(size);
+        record->level = static_cast<uint8_t>(level);
+        std::memcpy(reinterpret_cast<uint8_t *>(record) + sizeof(*record), args, size);
+        store_release(record->slot, start);
+    }
+}
+
+namespace pie::logging {
+    BinaryLogger::BinaryLogger(const BinaryLoggerConfig &config) {
+        data = std::make_shared<BinaryLoggerData>();
+        auto data_slots = std::max<uint64_t>(config.capacity / binary_log::slot_size,
+                                             binary_log::record_slots(LogArgs::max_size));
+        auto formats_offset = binary_log::align8(sizeof(binary_log::FileHeader));
+        auto data_offset = binary_log::align8(formats_offset + config.formats_capacity);
+        data->mapped_size = data_offset + data_slots * binary_log::slot_size;
+
+        data->fd = open(config.file.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (data->fd < 0)
+            throw std::runtime_error("Failed to open binary log file: " + config.file + ", " + strerror(errno));
+
+        if (ftruncate(data->fd, static_cast<off_t>(data->mapped_size)) != 0) {
+            close(data->fd);
+            throw std::runtime_error("Failed to resize binary log file: " + config.file + ", " + strerror(errno));
+        }
+
+        auto mapped = mmap(nullptr, data->mapped_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, data->fd, 0);
+        if (mapped == MAP_FAILED) {
+            close(data->fd);
+            throw std::runtime_error("Failed to map binary log file: " + config.file + ", " + strerror(errno));
+        }
+
+        data->mapped = static_cast<uint8_t *>(mapped);
+        data->header = reinterpret_cast<binary_log::FileHeader *>(data->mapped);
+        data->data = data->mapped + data_offset;
+
+        auto header = data->header;
+        std::memcpy(header->magic, binary_log::magic, sizeof(header->magic));
+        header->version = binary_log::version;
+        header->slot_size = binary_log::slot_size;
+        header->formats_offset = formats_offset;
+        header->formats_capacity = config.formats_capacity;
+        header->data_offset = data_offset;
+        header->data_slots = data_slots;
+        header->formats_size = 0;
+        store_release(header->write_slot, 0);
+    }
+
+    BinaryLogger::~BinaryLogger() {
+        msync(data->mapped, data->mapped_size, MS_SYNC);
+        munmap(data->mapped, data->mapped_size);
+        close(data->fd);
+    }
+
+    void BinaryLogger::log(LogLevel level, std::string message) {
+        if (!is_enabled(level))
+            return;
+
+        LogArgs args;
+        args.append(message);
+        log_record(level, text_format(), args.data(), args.size());
+    }
+
+    void BinaryLogger::log_record(LogLevel level, const LogFormat &format, const uint8_t *args, size_t size) {
+        if (!sync_formats(*data, format.id)) {
+            data->dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        write_record(*data, level, format.id, args, size);
+    }
+
+    uint64_t BinaryLogger::dropped() const {
+        return data->dropped.load(std::memory_order_relaxed);
+    }
+}
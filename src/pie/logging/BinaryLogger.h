@@ -0,0 +1,54 @@
+/**
+* @file BinaryLogger.h
+* @author Ilija Poznic
+* @date 2025
+*/
+
+#pragma once
+#include "Logger.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace pie::logging {
+    struct BinaryLoggerConfig {
+        // created or truncated
+        std::string file{};
+        // size of record ring, oldest records are overwritten
+        size_t capacity{16 * 1024 * 1024};
+        // size of formats table
+        size_t formats_capacity{256 * 1024};
+    };
+
+    struct BinaryLoggerData;
+
+    /**
+     * Logger which stores records in memory mapped file without formatting them: format id, timestamp,
+     * thread and raw arguments. Records survive process crash, file is decoded offline by pie_log_decode.
+     * Text messages (log) are stored as string argument.
+     */
+    class BinaryLogger : public Logger {
+    public:
+        explicit BinaryLogger(const BinaryLoggerConfig &config);
+
+        ~BinaryLogger() override;
+
+        BinaryLogger(const BinaryLogger &) = delete;
+
+        BinaryLogger &operator=(const BinaryLogger &) = delete;
+
+        void log(LogLevel level, std::string message) override;
+
+        void log_record(LogLevel level, const LogFormat &format, const uint8_t *args, size_t size) override;
+
+        /**
+         * @return records not stored because formats table is full
+         */
+        [[nodiscard]] uint64_t dropped() const;
+
+    private:
+        std::shared_ptr<BinaryLoggerData> data;
+    };
+}
@@ -9,16 +9,11 @@
 #include <iostream>
 
 namespace pie::logging {
-
-    void ConsoleLogger::log_level(const LogLevel set) {
-        level = set;
-    }
-
     void ConsoleLogger::log(LogLevel as_level, std::string message) {
-        if (as_level >= this->level) {
-            std::cout << level << " | " << message << std::endl;
-            if (level == LogLevel::Error)
-                std::cerr << level << " | " << message << std::endl;
+        if (is_enabled(as_level)) {
+            std::cout << as_level << " | " << message << std::endl;
+            if (as_level == LogLevel::Error)
+                std::cerr << as_level << " | " << message << std::endl;
         }
     }
 }
@@ -10,11 +10,6 @@
 namespace pie::logging {
     class ConsoleLogger : public Logger {
     public:
-        void log_level(const LogLevel set);
-
         void log(LogLevel level, std::string message) override;
-
-    private:
-        LogLevel level{LogLevel::Trace};
     };
 }
@@ -10,27 +10,23 @@
 #include <ostream>
 #include <sstream>
 
-inline std::ostream &operator<<(std::ostream &os, const pie::LogLevel &log_level) {
+inline const char *to_short_string(const pie::LogLevel &log_level) {
     switch (log_level) {
         case pie::LogLevel::Trace:
-            os << "TRC";
-            break;
+            return "TRC";
         case pie::LogLevel::Debug:
-            os << "DBG";
-            break;
+            return "DBG";
         case pie::LogLevel::Information:
-            os << "INF";
-            break;
+            return "INF";
         case pie::LogLevel::Warning:
-            os << "WRN";
-            break;
+            return "WRN";
         case pie::LogLevel::Error:
-            os << "ERR";
-            break;
+            return "ERR";
         default:
-            os << "___";
-            break;
+            return "___";
     }
+}
 
-    return os;
+inline std::ostream &operator<<(std::ostream &os, const pie::LogLevel &log_level) {
+    return os << to_short_string(log_level);
 }
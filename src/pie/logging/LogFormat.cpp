@@ -0,0 +1,138 @@
+/**
+* @file LogFormat.cpp
+* @author Ilija Poznic
+* @date 2025
+*/
+
+#include "LogFormat.h"
+
+#include <deque>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+    struct LogFormatRegistry {
+        std::mutex mutex{};
+        std::deque<pie::logging::LogFormat> formats{};
+    };
+
+    LogFormatRegistry &registry() {
+        static LogFormatRegistry registry{};
+        return registry;
+    }
+
+    /**
+     * Write next argument to os
+     * @return number of consumed bytes, 0 if argument is malformed
+     */
+    size_t decode_arg(std::ostream &os, const uint8_t *args, size_t size) {
+        if (size == 0)
+            return 0;
+
+        auto type = static_cast<pie::logging::LogArgType>(args[0]);
+        switch (type) {
+            case pie::logging::LogArgType::U64: {
+                uint64_t value{0};
+                if (size < 1 + sizeof(value))
+                    return 0;
+
+                std::memcpy(&value, args + 1, sizeof(value));
+                os << value;
+                return 1 + sizeof(value);
+            }
+            case pie::logging::LogArgType::I64: {
+                int64_t value{0};
+                if (size < 1 + sizeof(value))
+                    return 0;
+
+                std::memcpy(&value, args + 1, sizeof(value));
+                os << value;
+                return 1 + sizeof(value);
+            }
+            case pie::logging::LogArgType::F64: {
+                double value{0};
+                if (size < 1 + sizeof(value))
+                    return 0;
+
+                std::memcpy(&value, args + 1, sizeof(value));
+                os << value;
+                return 1 + sizeof(value);
+            }
+            case pie::logging::LogArgType::String:
+            case pie::logging::LogArgType::Bytes: {
+                uint16_t value_size{0};
+                if (size < 1 + sizeof(value_size))
+                    return 0;
+
+                std::memcpy(&value_size, args + 1, sizeof(value_size));
+                if (size < 1 + sizeof(value_size) + value_size)
+                    return 0;
+
+                auto value = args + 1 + sizeof(value_size);
+                if (type == pie::logging::LogArgType::String) {
+                    os.write(reinterpret_cast<const char *>(value), value_size);
+                } else {
+                    auto flags = os.flags();
+                    os << std::hex << std::uppercase << std::setfill('0');
+                    for (uint16_t i = 0; i < value_size; ++i)
+                        os << std::setw(2) << static_cast<unsigned>(value[i]);
+
+                    os.flags(flags);
+                }
+
+                return 1 + sizeof(value_size) + value_size;
+            }
+        }
+
+        return 0;
+    }
+}
+
+namespace pie::logging {
+    const LogFormat &register_format(const LogTag &tag, std::string_view format) {
+        auto &r = registry();
+        std::lock_guard<std::mutex> locker(r.mutex);
+        if (r.formats.size() >= UINT16_MAX)
+            throw std::length_error("Too many log formats");
+
+        auto id = static_cast<uint16_t>(r.formats.size() + 1);
+        return r.formats.emplace_back(LogFormat{id, &tag, std::string{format}});
+    }
+
+    uint16_t formats_count() {
+        auto &r = registry();
+        std::lock_guard<std::mutex> locker(r.mutex);
+        return static_cast<uint16_t>(r.formats.size());
+    }
+
+    const LogFormat &format_by_id(uint16_t id) {
+        auto &r = registry();
+        std::lock_guard<std::mutex> locker(r.mutex);
+        return r.formats.at(id - 1);
+    }
+
+    std::string format_record(const std::string &format, const uint8_t *args, size_t size) {
+        std::stringstream ss;
+        size_t offset{0};
+        size_t pos{0};
+        while (pos < format.size()) {
+            auto placeholder = format.find("{}", pos);
+            if (placeholder == std::string::npos) {
+                ss.write(format.data() + pos, static_cast<std::streamsize>(format.size() - pos));
+                break;
+            }
+
+            ss.write(format.data() + pos, static_cast<std::streamsize>(placeholder - pos));
+            auto consumed = decode_arg(ss, args + offset, size - offset);
+            if (consumed == 0)
+                ss << "{?}";
+
+            offset += consumed;
+            pos = placeholder + 2;
+        }
+
+        return ss.str();
+    }
+}
@@ -0,0 +1,143 @@
+/**
+* @file LogFormat.h
+* @author Ilija Poznic
+* @date 2025
+*
+* Structured log records: static format registered once per call site plus raw arguments.
+*
+*     static const auto &format = pie::logging::register_format(TAG, "write path: {}, value: {}");
+*
+* TAG is pie::logging::LogTag (LogTag.h).
+*     pie::logger::log_format<LogLevel::Trace>(logger, format, path, pie::logging::LogBytes{value});
+*
+* Text loggers format record only if level is enabled, BinaryLogger stores format id and arguments as is.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace pie::logging {
+    class LogTag;
+
+    struct LogFormat {
+        uint16_t id{0};
+        const LogTag *tag{nullptr};
+        std::string format;
+    };
+
+    /**
+     * Register format, "{}" is replaced by next argument. Thread safe, returned reference stays valid.
+     */
+    const LogFormat &register_format(const LogTag &tag, std::string_view format);
+
+    /**
+     * @return number of registered formats, ids are 1..count
+     */
+    uint16_t formats_count();
+
+    /**
+     * @param id - 1..formats_count()
+     */
+    const LogFormat &format_by_id(uint16_t id);
+
+    enum class LogArgType : uint8_t {
+        U64 = 1,
+        I64 = 2,
+        F64 = 3,
+        String = 4,
+        Bytes = 5
+    };
+
+    /**
+     * Payload argument, logged as hex
+     */
+    struct LogBytes {
+        LogBytes(const uint8_t *data, size_t size) : data(data), size(size) {
+        }
+
+        explicit LogBytes(const std::vector<uint8_t> &bytes) : data(bytes.data()), size(bytes.size()) {
+        }
+
+        const uint8_t *data;
+        size_t size;
+    };
+
+    /**
+     * Arguments of one record encoded on stack as [type][value], strings and bytes as [type][u16 size][data].
+     * Arguments which do not fit are truncated.
+     */
+    class LogArgs {
+    public:
+        static constexpr size_t max_size{1024};
+
+        template<typename T>
+        void append(const T &value) {
+            if constexpr (std::is_same_v<T, bool>) {
+                append_fixed(LogArgType::U64, static_cast<uint64_t>(value));
+            } else if constexpr (std::is_enum_v<T>) {
+                append_fixed(LogArgType::I64, static_cast<int64_t>(value));
+            } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+                append_fixed(LogArgType::I64, static_cast<int64_t>(value));
+            } else if constexpr (std::is_integral_v<T>) {
+                append_fixed(LogArgType::U64, static_cast<uint64_t>(value));
+            } else if constexpr (std::is_floating_point_v<T>) {
+                append_fixed(LogArgType::F64, static_cast<double>(value));
+            } else if constexpr (std::is_same_v<T, LogBytes>) {
+                append_sized(LogArgType::Bytes, value.data, value.size);
+            } else {
+                std::string_view text{value};
+                append_sized(LogArgType::String, reinterpret_cast<const uint8_t *>(text.data()), text.size());
+            }
+        }
+
+        [[nodiscard]] const uint8_t *data() const {
+            return buffer.data();
+        }
+
+        [[nodiscard]] size_t size() const {
+            return size_;
+        }
+
+    private:
+        template<typename T>
+        void append_fixed(LogArgType type, T value) {
+            if (size_ + 1 + sizeof(T) > buffer.size())
+                return;
+
+            buffer[size_++] = static_cast<uint8_t>(type);
+            std::memcpy(buffer.data() + size_, &value, sizeof(T));
+            size_ += sizeof(T);
+        }
+
+        void append_sized(LogArgType type, const uint8_t *value, size_t value_size) {
+            if (size_ + 1 + sizeof(uint16_t) > buffer.size())
+                return;
+
+            auto size = static_cast<uint16_t>(std::min(value_size, buffer.size() - size_ - 1 - sizeof(uint16_t)));
+            buffer[size_++] = static_cast<uint8_t>(type);
+            std::memcpy(buffer.data() + size_, &size, sizeof(size));
+            size_ += sizeof(size);
+            if (size > 0)
+                std::memcpy(buffer.data() + size_, value, size);
+
+            size_ += size;
+        }
+
+        std::array<uint8_t, max_size> buffer;
+        size_t size_{0};
+    };
+
+    /**
+     * Replace "{}" in format with decoded arguments
+     */
+    std::string format_record(const std::string &format, const uint8_t *args, size_t size);
+}
@@ -0,0 +1,108 @@
+/**
+* @file LogTag.cpp
+* @author Ilija Poznic
+* @date 2025
+*/
+
+#include "LogTag.h"
+
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+
+namespace {
+    struct LogTagRegistry {
+        std::mutex mutex{};
+        std::deque<pie::logging::LogTag> tags{};
+        pie::LogLevel default_level{pie::LogLevel::Trace};
+    };
+
+    LogTagRegistry &registry() {
+        static LogTagRegistry registry{};
+        return registry;
+    }
+
+    pie::logging::LogTag *find(LogTagRegistry &r, std::string_view name) {
+        for (auto &tag: r.tags) {
+            if (tag.name() == name)
+                return &tag;
+        }
+
+        return nullptr;
+    }
+}
+
+namespace pie::logging {
+    LogTag &register_tag(std::string_view name) {
+        auto &r = registry();
+        std::lock_guard<std::mutex> locker(r.mutex);
+        if (auto tag = find(r, name))
+            return *tag;
+
+        if (r.tags.size() >= UINT16_MAX)
+            throw std::length_error("Too many log tags");
+
+        return r.tags.emplace_back(static_cast<uint16_t>(r.tags.size()), std::string{name}, r.default_level);
+    }
+
+    bool set_tag_level(std::string_view name, LogLevel level) {
+        auto &r = registry();
+        std::lock_guard<std::mutex> locker(r.mutex);
+        auto tag = find(r, name);
+        if (!tag)
+            return false;
+
+        tag->level(level);
+        return true;
+    }
+
+    void set_tags_level(LogLevel level) {
+        auto &r = registry();
+        std::lock_guard<std::mutex> locker(r.mutex);
+        r.default_level = level;
+        for (auto &tag: r.tags)
+            tag.level(level);
+    }
+
+    std::vector<std::pair<std::string, LogLevel> > tag_levels() {
+        auto &r = registry();
+        std::lock_guard<std::mutex> locker(r.mutex);
+        std::vector<std::pair<std::string, LogLevel> > levels{};
+        levels.reserve(r.tags.size());
+        for (const auto &tag: r.tags)
+            levels.emplace_back(tag.name(), tag.level());
+
+        return levels;
+    }
+
+    const char *to_string(LogLevel level) {
+        switch (level) {
+            case LogLevel::Trace:
+                return "Trace";
+            case LogLevel::Debug:
+                return "Debug";
+            case LogLevel::Information:
+                return "Information";
+            case LogLevel::Warning:
+                return "Warning";
+            case LogLevel::Error:
+                return "Error";
+            case LogLevel::None:
+                return "None";
+        }
+
+        return "Unknown";
+    }
+
+    std::optional<LogLevel> log_level_from_string(std::string_view level) {
+        for (auto candidate: {
+                 LogLevel::Trace, LogLevel::Debug, LogLevel::Information, LogLevel::Warning, LogLevel::Error,
+                 LogLevel::None
+             }) {
+            if (level == to_string(candidate))
+                return candidate;
+        }
+
+        return std::nullopt;
+    }
+}
@@ -0,0 +1,80 @@
+/**
+* @file LogTag.h
+* @author Ilija Poznic
+* @date 2025
+*
+* Per tag runtime log levels. Tag is registered once per module and checked with single relaxed load:
+*
+*     inline const pie::logging::LogTag &TAG = pie::logging::register_tag("gatt::Characteristic");
+*     pie::logger::log_lazy<LogLevel::Trace>(logger, TAG, ...);
+*/
+
+#pragma once
+
+#include "Logger.h"
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace pie::logging {
+    class LogTag {
+    public:
+        LogTag(uint16_t id, std::string name, LogLevel level) : id_(id), name_(std::move(name)), level_(level) {
+        }
+
+        [[nodiscard]] uint16_t id() const {
+            return id_;
+        }
+
+        [[nodiscard]] const std::string &name() const {
+            return name_;
+        }
+
+        [[nodiscard]] LogLevel level() const {
+            return level_.load(std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] bool is_enabled(LogLevel as_level) const {
+            return as_level >= level_.load(std::memory_order_relaxed);
+        }
+
+        void level(LogLevel set) {
+            level_.store(set, std::memory_order_relaxed);
+        }
+
+    private:
+        uint16_t id_;
+        std::string name_;
+        std::atomic<LogLevel> level_;
+    };
+
+    /**
+     * Register tag or return already registered one. Returned reference stays valid.
+     * New tags start with default level (Trace).
+     */
+    LogTag &register_tag(std::string_view name);
+
+    /**
+     * @return false if tag is not registered
+     */
+    bool set_tag_level(std::string_view name, LogLevel level);
+
+    /**
+     * Set level of all registered tags and default level of tags registered later
+     */
+    void set_tags_level(LogLevel level);
+
+    std::vector<std::pair<std::string, LogLevel> > tag_levels();
+
+    const char *to_string(LogLevel level);
+
+    /**
+     * @param level - Trace, Debug, Information, Warning, Error or None
+     */
+    std::optional<LogLevel> log_level_from_string(std::string_view level);
+}
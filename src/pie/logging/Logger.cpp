@@ -0,0 +1,17 @@
+/**
+* @file Logger.cpp
+* @author Ilija Poznic
+* @date 2025
+*/
+
+#include "Logger.h"
+#include "LogTag.h"
+
+namespace pie {
+    void Logger::log_record(LogLevel level, const logging::LogFormat &format, const uint8_t *args, size_t size) {
+        if (!format.tag || format.tag->name().empty())
+            log(level, logging::format_record(format.format, args, size));
+        else
+            log(level, format.tag->name() + "|" + logging::format_record(format.format, args, size));
+    }
+}
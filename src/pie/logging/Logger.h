@@ -6,6 +6,11 @@
 
 #pragma once
 
+#include "LogFormat.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <string>
 
 namespace pie {
@@ -23,5 +28,28 @@ namespace pie {
         virtual ~Logger() = default;
 
         virtual void log(LogLevel level, std::string message) = 0;
+
+        /**
+         * Structured record, see pie::logger::log_format. Text loggers format it and call log
+         */
+        virtual void log_record(LogLevel level, const logging::LogFormat &format, const uint8_t *args, size_t size);
+
+        /**
+         * Runtime minimum level, messages below it are not formatted by pie::logger::log_lazy
+         */
+        void log_level(LogLevel set) {
+            level.store(set, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] LogLevel log_level() const {
+            return level.load(std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] bool is_enabled(LogLevel as_level) const {
+            return as_level >= level.load(std::memory_order_relaxed);
+        }
+
+    private:
+        std::atomic<LogLevel> level{LogLevel::Trace};
     };
 }
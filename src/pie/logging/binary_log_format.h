@@ -0,0 +1,70 @@
+/**
+* @file binary_log_format.h
+* @author Ilija Poznic
+* @date 2025
+*
+* Layout of BinaryLogger file, shared with pie_log_decode.
+*
+* [BinaryLogFileHeader][formats table][data slots]
+*
+* Formats table holds BinaryLogFormatEntry + tag + format for every format used in file.
+* Data is a ring of fixed size slots, record (BinaryLogRecordHeader + arguments) takes one or more
+* consecutive slots and never wraps, rest of the ring is skipped with padding record (format_id 0).
+* Record is valid only if its header slot is equal to its absolute slot number, which is written last.
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace pie::logging::binary_log {
+    inline constexpr char magic[8] = {'P', 'I', 'E', 'B', 'L', 'O', 'G', '\0'};
+    inline constexpr uint32_t version{1};
+    inline constexpr uint32_t slot_size{64};
+    inline constexpr uint16_t padding_format_id{0};
+
+    struct FileHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t slot_size;
+        uint64_t formats_offset;
+        uint64_t formats_capacity;
+        uint64_t data_offset;
+        uint64_t data_slots;
+        // bytes used in formats table, updated atomically after entry is written
+        uint64_t formats_size;
+        // next free absolute slot, updated atomically
+        uint64_t write_slot;
+    };
+
+    struct FormatEntry {
+        uint16_t id;
+        uint16_t tag_size;
+        uint16_t format_size;
+        uint16_t reserved;
+        // followed by tag and format, entry size padded to 8 bytes
+    };
+
+    struct RecordHeader {
+        uint64_t slot;
+        // CLOCK_REALTIME
+        uint64_t timestamp_ns;
+        uint32_t thread_id;
+        uint16_t format_id;
+        // size of encoded arguments (pie::logging::LogArgs)
+        uint16_t size;
+        uint8_t level;
+        uint8_t reserved[7];
+    };
+
+    static_assert(sizeof(RecordHeader) == 32);
+
+    inline constexpr size_t align8(size_t size) {
+        return (size + 7) & ~static_cast<size_t>(7);
+    }
+
+    inline constexpr uint64_t record_slots(size_t args_size) {
+        return (sizeof(RecordHeader) + args_size + slot_size - 1) / slot_size;
+    }
+}
@@ -8,6 +8,7 @@
 
 
 #include "pie/logging/Logger.h"
+#include "pie/logging/LogTag.h"
 
 #include <memory>
 #include <string>
@@ -32,6 +33,19 @@ namespace pie::logger {
                              const std::string &message) {
 #ifndef NDEBUG
         log(l, tag, level, message);
+#endif
+    }
+
+    inline void log(const std::shared_ptr<pie::Logger> &l, const pie::logging::LogTag &tag, const LogLevel level,
+                    const std::string &message) {
+        if (tag.is_enabled(level))
+            log(l, tag.name(), level, message);
+    }
+
+    inline void log_if_debug(const std::shared_ptr<pie::Logger> &l, const pie::logging::LogTag &tag,
+                             const LogLevel level, const std::string &message) {
+#ifndef NDEBUG
+        log(l, tag, level, message);
 #endif
     }
 }
@@ -0,0 +1,80 @@
+/**
+* @file log.h
+* @author Ilija Poznic
+* @date 2025
+*
+* Lazy logging front end. Message is formatted only if level is compiled in (PIE_LOG_MIN_LEVEL),
+* enabled for tag (pie::logging::LogTag) and enabled on logger at runtime:
+*
+*     pie::logger::log_lazy<LogLevel::Trace>(logger, TAG, [&](std::ostream &os) {
+*         os << "send: " << pie::dbus::get_message_info(msg);
+*     });
+*
+* or as structured record (see LogFormat.h), which BinaryLogger stores without formatting.
+*/
+
+#pragma once
+
+#include "pie/logging/Logger.h"
+#include "pie/logging/LogTag.h"
+
+#include <memory>
+#include <ostream>
+#include <sstream>
+#include <string>
+
+/**
+ * Compile time minimum level as pie::LogLevel value (0 - Trace ... 5 - None).
+ * Levels below it are removed from build. Defaults to Trace in debug and Information in release build.
+ */
+#ifndef PIE_LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define PIE_LOG_MIN_LEVEL 2
+#else
+#define PIE_LOG_MIN_LEVEL 0
+#endif
+#endif
+
+namespace pie::logger {
+    inline constexpr LogLevel compiled_min_level = static_cast<LogLevel>(PIE_LOG_MIN_LEVEL);
+
+    constexpr bool is_compiled(LogLevel level) {
+        return level >= compiled_min_level;
+    }
+
+    inline bool is_enabled(const std::shared_ptr<pie::Logger> &l, const pie::logging::LogTag &tag, LogLevel level) {
+        return is_compiled(level) && tag.is_enabled(level) && l && l->is_enabled(level);
+    }
+
+    /**
+     * @param format callable(std::ostream &), called only if level is enabled
+     */
+    template<LogLevel Level, typename Format>
+    inline void log_lazy(const std::shared_ptr<pie::Logger> &l, const pie::logging::LogTag &tag, Format &&format) {
+        if constexpr (is_compiled(Level)) {
+            if (!tag.is_enabled(Level) || !l || !l->is_enabled(Level))
+                return;
+
+            std::stringstream ss;
+            ss << tag.name() << "|";
+            format(static_cast<std::ostream &>(ss));
+            l->log(Level, ss.str());
+        }
+    }
+
+    /**
+     * @param args - integers, floating point, strings or pie::logging::LogBytes, encoded only if level is enabled
+     */
+    template<LogLevel Level, typename... Args>
+    inline void log_format(const std::shared_ptr<pie::Logger> &l, const pie::logging::LogFormat &format,
+                           const Args &... args) {
+        if constexpr (is_compiled(Level)) {
+            if (!format.tag->is_enabled(Level) || !l || !l->is_enabled(Level))
+                return;
+
+            pie::logging::LogArgs log_args;
+            (log_args.append(args), ...);
+            l->log_record(Level, format, log_args.data(), log_args.size());
+        }
+    }
+}
@@ -0,0 +1,59 @@
+/**
+ * @file Counter.h
+ * @author Ilija Poznic
+ * @date 2025
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace pie::metrics {
+    constexpr size_t cache_line_size{64};
+
+    /**
+     * Shard of calling thread in range [0, count), threads are assigned round robin on first use
+     */
+    inline size_t thread_shard(size_t count) {
+        static std::atomic<size_t> next{0};
+        thread_local size_t shard = next.fetch_add(1, std::memory_order_relaxed);
+        return shard % count;
+    }
+
+    /**
+     * Monotonic counter. Every thread adds to its own cache line, value() sums all shards.
+     * add and value are lock-free and can be called from any thread.
+     */
+    class Counter {
+    public:
+        static constexpr size_t shard_count{8};
+
+        Counter() = default;
+
+        Counter(const Counter &) = delete;
+
+        Counter &operator=(const Counter &) = delete;
+
+        void add(uint64_t n = 1) {
+            shards[thread_shard(shard_count)].value.fetch_add(n, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] uint64_t value() const {
+            uint64_t sum{0};
+            for (const auto &shard: shards)
+                sum += shard.value.load(std::memory_order_relaxed);
+
+            return sum;
+        }
+
+    private:
+        struct alignas(cache_line_size) Shard {
+            std::atomic<uint64_t> value{0};
+        };
+
+        std::array<Shard, shard_count> shards{};
+    };
+}
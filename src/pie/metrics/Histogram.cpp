@@ -0,0 +1,63 @@
+/**
+ * @file Histogram.cpp
+ * @author Ilija Poznic
+ * @date 2025
+ */
+
+#include "Histogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace pie::metrics {
+    uint64_t HistogramSnapshot::percentile(double p) const {
+        if (count == 0)
+            return 0;
+
+        auto target = static_cast<uint64_t>(std::ceil(std::clamp(p, 0.0, 100.0) / 100.0 * static_cast<double>(count)));
+        target = std::max<uint64_t>(target, 1);
+        uint64_t seen{0};
+        for (size_t i = 0; i < buckets.size(); ++i) {
+            seen += buckets[i];
+            if (seen >= target)
+                return std::min(Histogram::bucket_upper_bound(i), max);
+        }
+
+        return max;
+    }
+
+    HistogramSnapshot Histogram::snapshot() const {
+        HistogramSnapshot snapshot{};
+        snapshot.buckets.resize(bucket_count);
+        for (const auto &shard: shards) {
+            for (size_t i = 0; i < bucket_count; ++i)
+                snapshot.buckets[i] += shard.buckets[i].load(std::memory_order_relaxed);
+
+            snapshot.sum += shard.sum.load(std::memory_order_relaxed);
+            snapshot.max = std::max(snapshot.max, shard.max.load(std::memory_order_relaxed));
+        }
+
+        // count from buckets keeps percentiles consistent while other threads record
+        for (auto bucket: snapshot.buckets)
+            snapshot.count += bucket;
+
+        return snapshot;
+    }
+
+    uint64_t Histogram::bucket_lower_bound(size_t index) {
+        if (index < sub_buckets)
+            return index;
+
+        auto group = index / sub_buckets;
+        auto sub_bucket = index % sub_buckets;
+        return static_cast<uint64_t>(sub_buckets + sub_bucket) << (group - 1);
+    }
+
+    uint64_t Histogram::bucket_upper_bound(size_t index) {
+        if (index + 1 >= bucket_count)
+            return std::numeric_limits<uint64_t>::max();
+
+        return bucket_lower_bound(index + 1) - 1;
+    }
+}
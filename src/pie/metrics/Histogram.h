@@ -0,0 +1,102 @@
+/**
+ * @file Histogram.h
+ * @author Ilija Poznic
+ * @date 2025
+ */
+
+#pragma once
+
+#include "Counter.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace pie::metrics {
+    struct HistogramSnapshot {
+        uint64_t count{0};
+        uint64_t sum{0};
+        uint64_t max{0};
+
+        /**
+         * Number of values per bucket, see Histogram::bucket_lower_bound
+         */
+        std::vector<uint64_t> buckets{};
+
+        /**
+         * @param p - percentile in range [0, 100]
+         * @return upper bound of bucket holding the percentile, never above max
+         */
+        [[nodiscard]] uint64_t percentile(double p) const;
+    };
+
+    /**
+     * HDR style histogram of unsigned values (e.g. nanoseconds). Every power of two is split in
+     * 8 linear buckets, so recorded value is known with at most 12.5% error up to 2^40.
+     * Larger values land in the last bucket. record is lock-free, every thread writes its own shard.
+     */
+    class Histogram {
+    public:
+        static constexpr unsigned sub_bucket_bits{3};
+        static constexpr size_t sub_buckets{size_t{1} << sub_bucket_bits};
+        static constexpr unsigned max_exponent{40};
+        static constexpr size_t bucket_count{(max_exponent - sub_bucket_bits + 2) * sub_buckets};
+        static constexpr size_t shard_count{4};
+
+        Histogram() = default;
+
+        Histogram(const Histogram &) = delete;
+
+        Histogram &operator=(const Histogram &) = delete;
+
+        void record(uint64_t value) {
+            auto &shard = shards[thread_shard(shard_count)];
+            shard.buckets[bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+            shard.sum.fetch_add(value, std::memory_order_relaxed);
+            auto max = shard.max.load(std::memory_order_relaxed);
+            while (value > max && !shard.max.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+            }
+        }
+
+        /**
+         * Record duration in nanoseconds
+         */
+        void record(std::chrono::steady_clock::duration duration) {
+            auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+            record(static_cast<uint64_t>(ns < 0 ? 0 : ns));
+        }
+
+        [[nodiscard]] HistogramSnapshot snapshot() const;
+
+        static size_t bucket_index(uint64_t value) {
+            if (value < sub_buckets)
+                return static_cast<size_t>(value);
+
+            auto exponent = static_cast<unsigned>(63 - __builtin_clzll(value));
+            if (exponent > max_exponent)
+                return bucket_count - 1;
+
+            auto sub_bucket = static_cast<size_t>(value >> (exponent - sub_bucket_bits)) - sub_buckets;
+            return (exponent - sub_bucket_bits + 1) * sub_buckets + sub_bucket;
+        }
+
+        static uint64_t bucket_lower_bound(size_t index);
+
+        /**
+         * @return largest value of bucket, UINT64_MAX for last bucket
+         */
+        static uint64_t bucket_upper_bound(size_t index);
+
+    private:
+        struct alignas(cache_line_size) Shard {
+            std::array<std::atomic<uint64_t>, bucket_count> buckets{};
+            std::atomic<uint64_t> sum{0};
+            std::atomic<uint64_t> max{0};
+        };
+
+        std::array<Shard, shard_count> shards{};
+    };
+}
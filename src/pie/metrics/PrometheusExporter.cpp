@@ -0,0 +1,290 @@
+/**
+ * @file PrometheusExporter.cpp
+ * @author Ilija Poznic
+ * @date 2025
+ */
+
+#include "PrometheusExporter.h"
+#include "Registry.h"
+
+#include <pie/logging/console_helpers.h>
+#include <pie/logging/LogTag.h>
+#include <pie/trace/Trace.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace pie::metrics {
+    struct PrometheusExporterData {
+        PrometheusExporterConfig config;
+        std::shared_ptr<pie::Logger> logger;
+        int listen_fd{-1};
+        int stop_fd{-1};
+        uint16_t port{0};
+        std::thread thread;
+    };
+}
+
+namespace {
+    inline const pie::logging::LogTag &TAG = pie::logging::register_tag("PrometheusExporter");
+
+    constexpr size_t max_request_size{8 * 1024};
+    constexpr int request_timeout_ms{1000};
+
+    // histogram buckets exported as le="2^k - 1" for k in [first_le_exponent, last_le_exponent] with step 2,
+    // le is inclusive and 2^k itself falls in the next bucket group
+    constexpr unsigned first_le_exponent{10};
+    constexpr unsigned last_le_exponent{36};
+
+    const char *to_string(pie::metrics::MetricType type) {
+        return type == pie::metrics::MetricType::Counter ? "counter" : "histogram";
+    }
+
+    void append_sample(std::string &text, const std::string &name, const char *suffix, const std::string &labels,
+                       const std::string &extra_label, uint64_t value) {
+        text += name;
+        text += suffix;
+        if (!labels.empty() || !extra_label.empty()) {
+            text += '{';
+            text += labels;
+            if (!labels.empty() && !extra_label.empty())
+                text += ',';
+            text += extra_label;
+            text += '}';
+        }
+
+        text += ' ';
+        text += std::to_string(value);
+        text += '\n';
+    }
+
+    void append_histogram(std::string &text, const pie::metrics::Metric &metric) {
+        auto snapshot = metric.histogram->snapshot();
+        uint64_t cumulative{0};
+        size_t bucket{0};
+        for (auto exponent = first_le_exponent; exponent <= last_le_exponent; exponent += 2) {
+            // first bucket of group starting at 2^exponent, all buckets below hold values <= 2^exponent - 1
+            auto end = (exponent - pie::metrics::Histogram::sub_bucket_bits + 1) * pie::metrics::Histogram::sub_buckets;
+            for (; bucket < end; ++bucket)
+                cumulative += snapshot.buckets[bucket];
+
+            append_sample(text, metric.name, "_bucket", metric.labels,
+                          "le=\"" + std::to_string((uint64_t{1} << exponent) - 1) + "\"", cumulative);
+        }
+
+        append_sample(text, metric.name, "_bucket", metric.labels, "le=\"+Inf\"", snapshot.count);
+        append_sample(text, metric.name, "_sum", metric.labels, {}, snapshot.sum);
+        append_sample(text, metric.name, "_count", metric.labels, {}, snapshot.count);
+    }
+
+    bool write_all(int fd, const std::string &text) {
+        size_t written{0};
+        while (written < text.size()) {
+            auto n = send(fd, text.data() + written, text.size() - written, MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR)
+                continue;
+
+            if (n <= 0)
+                return false;
+
+            written += static_cast<size_t>(n);
+        }
+
+        return true;
+    }
+
+    /**
+     * Read request head, any GET of / or /metrics is answered with metrics
+     */
+    void serve(int fd) {
+        timeval timeout{0, request_timeout_ms * 1000};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+        std::string request{};
+        char buffer[1024];
+        while (request.size() < max_request_size && request.find("\r\n\r\n") == std::string::npos) {
+            auto n = recv(fd, buffer, sizeof(buffer), 0);
+            if (n < 0 && errno == EINTR)
+                continue;
+
+            if (n <= 0)
+                break;
+
+            request.append(buffer, static_cast<size_t>(n));
+        }
+
+        std::string status{"404 Not Found"};
+        std::string body{};
+        if (request.rfind("GET /metrics ", 0) == 0 || request.rfind("GET / ", 0) == 0) {
+            status = "200 OK";
+            body = pie::metrics::prometheus_text();
+        }
+
+        std::string response{"HTTP/1.1 "};
+        response += status;
+        response += "\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: ";
+        response += std::to_string(body.size());
+        response += "\r\nConnection: close\r\n\r\n";
+        response += body;
+        write_all(fd, response);
+    }
+
+    void run(pie::metrics::PrometheusExporterData &data) {
+        PIE_TRACE_THREAD_NAME("PrometheusExporter");
+        pollfd fds[2]{{data.listen_fd, POLLIN, 0}, {data.stop_fd, POLLIN, 0}};
+        while (true) {
+            auto ready = poll(fds, 2, -1);
+            if (ready < 0 && errno == EINTR)
+                continue;
+
+            if (ready < 0 || (fds[1].revents & POLLIN))
+                return;
+
+            if (!(fds[0].revents & POLLIN))
+                continue;
+
+            auto fd = accept4(data.listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+            if (fd < 0)
+                continue;
+
+            try {
+                PIE_TRACE_SCOPE("PrometheusExporter::scrape");
+                serve(fd);
+            } catch (const std::exception &e) {
+                pie::logger::log(data.logger, TAG, pie::LogLevel::Warning, std::string{"scrape error: "} + e.what());
+            }
+
+            close(fd);
+        }
+    }
+
+    [[noreturn]] void throw_error(const std::string &what) {
+        throw std::runtime_error("PrometheusExporter: " + what + ", " + strerror(errno));
+    }
+
+    int listen_unix(const std::string &path) {
+        sockaddr_un address{};
+        if (path.size() >= sizeof(address.sun_path))
+            throw std::runtime_error("PrometheusExporter: socket path too long: " + path);
+
+        auto fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0)
+            throw_error("failed to create socket");
+
+        address.sun_family = AF_UNIX;
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+        unlink(path.c_str());
+        if (bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || listen(fd, 4) != 0) {
+            auto error = errno;
+            close(fd);
+            errno = error;
+            throw_error("failed to listen on " + path);
+        }
+
+        return fd;
+    }
+
+    int listen_tcp(uint16_t port, uint16_t &bound_port) {
+        auto fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0)
+            throw_error("failed to create socket");
+
+        int reuse{1};
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t size = sizeof(address);
+        if (bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0 || listen(fd, 4) != 0 ||
+            getsockname(fd, reinterpret_cast<sockaddr *>(&address), &size) != 0) {
+            auto error = errno;
+            close(fd);
+            errno = error;
+            throw_error("failed to listen on 127.0.0.1:" + std::to_string(port));
+        }
+
+        bound_port = ntohs(address.sin_port);
+        return fd;
+    }
+}
+
+namespace pie::metrics {
+    PrometheusExporter::PrometheusExporter(const PrometheusExporterConfig &config,
+                                           const std::shared_ptr<Logger> &logger) {
+        data = std::make_shared<PrometheusExporterData>();
+        data->config = config;
+        data->logger = logger;
+        data->listen_fd = config.unix_path.empty()
+                              ? listen_tcp(config.tcp_port, data->port)
+                              : listen_unix(config.unix_path);
+        data->stop_fd = eventfd(0, EFD_CLOEXEC);
+        if (data->stop_fd < 0) {
+            close(data->listen_fd);
+            throw_error("failed to create eventfd");
+        }
+
+        data->thread = std::thread([p_data = data.get()] {
+            run(*p_data);
+        });
+    }
+
+    PrometheusExporter::~PrometheusExporter() {
+        uint64_t value{1};
+        if (write(data->stop_fd, &value, sizeof(value)) < 0)
+            pie::logger::log(data->logger, TAG, LogLevel::Warning, "failed to stop exporter thread");
+
+        if (data->thread.joinable())
+            data->thread.join();
+
+        close(data->stop_fd);
+        close(data->listen_fd);
+        if (!data->config.unix_path.empty())
+            unlink(data->config.unix_path.c_str());
+    }
+
+    uint16_t PrometheusExporter::port() const {
+        return data->port;
+    }
+
+    std::string prometheus_text() {
+        auto all = metrics();
+        std::string text{};
+        text.reserve(all.size() * 256);
+
+        // samples of the same name are grouped under single HELP and TYPE
+        std::vector<bool> done(all.size(), false);
+        for (size_t i = 0; i < all.size(); ++i) {
+            if (done[i])
+                continue;
+
+            const auto &first = *all[i];
+            text += "# HELP " + first.name + " " + first.help + "\n";
+            text += "# TYPE " + first.name + " " + to_string(first.type) + "\n";
+            for (size_t j = i; j < all.size(); ++j) {
+                const auto &metric = *all[j];
+                if (done[j] || metric.name != first.name || metric.type != first.type)
+                    continue;
+
+                done[j] = true;
+                if (metric.type == MetricType::Counter)
+                    append_sample(text, metric.name, "", metric.labels, {}, metric.counter->value());
+                else
+                    append_histogram(text, metric);
+            }
+        }
+
+        return text;
+    }
+}
@@ -0,0 +1,60 @@
+/**
+ * @file PrometheusExporter.h
+ * @author Ilija Poznic
+ * @date 2025
+ */
+
+#pragma once
+
+#include <pie/logging/Logger.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace pie::metrics {
+    struct PrometheusExporterConfig {
+        /**
+         * Unix domain socket path, used if not empty. Stale socket file is removed.
+         */
+        std::string unix_path{};
+
+        /**
+         * TCP port on 127.0.0.1, used if unix_path is empty. 0 - any free port, see PrometheusExporter::port
+         */
+        uint16_t tcp_port{9464};
+    };
+
+    struct PrometheusExporterData;
+
+    /**
+     * Serves all registered metrics in Prometheus text format (HTTP GET /metrics) from its own thread.
+     * Scrape reads metrics without locks, it never waits for DBus thread or any other writer.
+     */
+    class PrometheusExporter {
+    public:
+        /**
+         * @throws std::runtime_error if socket can not be bound
+         */
+        PrometheusExporter(const PrometheusExporterConfig &config, const std::shared_ptr<Logger> &logger);
+
+        ~PrometheusExporter();
+
+        PrometheusExporter(const PrometheusExporter &) = delete;
+
+        PrometheusExporter &operator=(const PrometheusExporter &) = delete;
+
+        /**
+         * @return bound TCP port, 0 for Unix domain socket
+         */
+        [[nodiscard]] uint16_t port() const;
+
+    private:
+        std::shared_ptr<PrometheusExporterData> data;
+    };
+
+    /**
+     * Render all registered metrics in Prometheus text exposition format 0.0.4
+     */
+    std::string prometheus_text();
+}
@@ -0,0 +1,87 @@
+/**
+ * @file Registry.cpp
+ * @author Ilija Poznic
+ * @date 2025
+ */
+
+#include "Registry.h"
+
+#include <array>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+
+namespace {
+    constexpr size_t max_metrics{1024};
+
+    /**
+     * Writers register under mutex, readers see metrics published before count without locking
+     */
+    struct MetricsRegistry {
+        std::mutex mutex{};
+        std::deque<pie::metrics::Metric> storage{};
+        std::array<const pie::metrics::Metric *, max_metrics> published{};
+        std::atomic<size_t> count{0};
+    };
+
+    MetricsRegistry &registry() {
+        static MetricsRegistry registry{};
+        return registry;
+    }
+
+    pie::metrics::Metric &register_metric(std::string_view name, std::string_view labels, std::string_view help,
+                                          pie::metrics::MetricType type) {
+        auto &r = registry();
+        std::lock_guard<std::mutex> locker(r.mutex);
+        for (auto &metric: r.storage) {
+            if (metric.name == name && metric.labels == labels) {
+                if (metric.type != type)
+                    throw std::invalid_argument("Metric registered with different type: " + std::string{name});
+
+                return metric;
+            }
+        }
+
+        auto count = r.count.load(std::memory_order_relaxed);
+        if (count >= max_metrics)
+            throw std::length_error("Too many metrics");
+
+        auto &metric = r.storage.emplace_back();
+        metric.name = name;
+        metric.labels = labels;
+        metric.help = help;
+        metric.type = type;
+        if (type == pie::metrics::MetricType::Counter)
+            metric.counter = std::make_unique<pie::metrics::Counter>();
+        else
+            metric.histogram = std::make_unique<pie::metrics::Histogram>();
+
+        r.published[count] = &metric;
+        r.count.store(count + 1, std::memory_order_release);
+        return metric;
+    }
+}
+
+namespace pie::metrics {
+    Counter &counter(std::string_view name, std::string_view labels, std::string_view help) {
+        return *register_metric(name, labels, help, MetricType::Counter).counter;
+    }
+
+    Histogram &histogram(std::string_view name, std::string_view labels, std::string_view help) {
+        return *register_metric(name, labels, help, MetricType::Histogram).histogram;
+    }
+
+    std::vector<const Metric *> metrics() {
+        auto &r = registry();
+        auto count = r.count.load(std::memory_order_acquire);
+        return {r.published.begin(), r.published.begin() + static_cast<std::ptrdiff_t>(count)};
+    }
+
+    std::string full_name(const Metric &metric) {
+        if (metric.labels.empty())
+            return metric.name;
+
+        return metric.name + "{" + metric.labels + "}";
+    }
+}
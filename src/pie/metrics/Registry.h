@@ -0,0 +1,62 @@
+/**
+ * @file Registry.h
+ * @author Ilija Poznic
+ * @date 2025
+ *
+ * Process wide metrics. Metric is registered once and the returned reference is kept, e.g.:
+ *
+ *     static auto &received = pie::metrics::counter("dbus_messages_received_total", "type=\"signal\"");
+ *     received.add();
+ */
+
+#pragma once
+
+#include "Counter.h"
+#include "Histogram.h"
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace pie::metrics {
+    enum class MetricType {
+        Counter,
+        Histogram
+    };
+
+    struct Metric {
+        std::string name;
+
+        /**
+         * Prometheus style labels without braces, e.g. path="/rs/pie", empty if none
+         */
+        std::string labels;
+        std::string help;
+        MetricType type{MetricType::Counter};
+        std::unique_ptr<pie::metrics::Counter> counter{};
+        std::unique_ptr<pie::metrics::Histogram> histogram{};
+    };
+
+    /**
+     * Register counter or return already registered one with the same name and labels.
+     * Returned reference stays valid for the lifetime of the process.
+     */
+    Counter &counter(std::string_view name, std::string_view labels = {}, std::string_view help = {});
+
+    /**
+     * Register histogram or return already registered one with the same name and labels.
+     * Returned reference stays valid for the lifetime of the process.
+     */
+    Histogram &histogram(std::string_view name, std::string_view labels = {}, std::string_view help = {});
+
+    /**
+     * All registered metrics in registration order. Lock-free, can be called from any thread.
+     */
+    std::vector<const Metric *> metrics();
+
+    /**
+     * @return name{labels} or name if there are no labels
+     */
+    std::string full_name(const Metric &metric);
+}
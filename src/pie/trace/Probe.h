@@ -0,0 +1,39 @@
+/**
+* @file Probe.h
+* @author Ilija Poznic
+* @date 2025
+*
+* USDT static probes (provider "pie") for bpftrace, perf and systemtap. Enabled with PIE_ENABLE_USDT,
+* otherwise macros expand to nothing. Probe site is a single nop until a tracer attaches, arguments are
+* evaluated always, so they should be values already at hand:
+*
+*     PIE_PROBE(dbus_reply, reply_serial, serial);
+*
+* List probes of a binary with `bpftrace -l 'usdt:./cpp_bluez_dbus_tx_example:pie:*'`, e.g. handler time:
+*
+*     bpftrace -e 'usdt:./cpp_bluez_dbus_tx_example:pie:dispatch_start { @s[tid] = nsecs; }
+*                  usdt:./cpp_bluez_dbus_tx_example:pie:dispatch_end /@s[tid]/ {
+*                      @ns[str(arg0)] = hist(nsecs - @s[tid]); delete(@s[tid]); }'
+*
+* Probes:
+*   dbus_receive(int type, char *path, char *member, u32 serial) - incoming message taken from connection
+*   dispatch_start(char *path, u32 serial), dispatch_end(char *path, u32 serial, int handled)
+*   queue_push(u64 depth) - command queued, depth before push
+*   queue_pop(u64 wait_ns) - command taken by DBus thread
+*   dbus_send(char *path, u32 serial) - message sent by queued command
+*   dbus_reply(u32 reply_serial, u32 serial) - reply sent from handler
+*   flush_start(), flush_end()
+*   gatt_write_value(char *path, u32 serial, u64 size)
+*   gatt_acquired_write(char *path, u64 size) - packet read from AcquireWrite socket
+*   value_changed(char *uuid, u64 size)
+*/
+
+#pragma once
+
+#ifdef PIE_ENABLE_USDT
+#include <sys/sdt.h>
+
+#define PIE_PROBE(name, ...) STAP_PROBEV(pie, name, ##__VA_ARGS__)
+#else
+#define PIE_PROBE(name, ...) static_cast<void>(0)
+#endif
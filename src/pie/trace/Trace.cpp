@@ -0,0 +1,186 @@
+/**
+* @file Trace.cpp
+* @author Ilija Poznic
+* @date 2025
+*/
+
+#include "Trace.h"
+
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+    struct Event {
+        std::atomic<const char *> name{nullptr};
+        std::atomic<uint64_t> start_ns{0};
+        std::atomic<uint64_t> end_ns{0};
+    };
+
+    /**
+     * Written only by owner thread, head is published after event is written
+     */
+    struct ThreadBuffer {
+        explicit ThreadBuffer(uint64_t tid) : tid(tid), events(std::make_unique<Event[]>(pie::trace::thread_capacity)) {
+        }
+
+        uint64_t tid;
+        std::string name{};
+        std::unique_ptr<Event[]> events;
+        std::atomic<uint64_t> head{0};
+    };
+
+    struct TraceRegistry {
+        std::mutex mutex{};
+        // buffers of finished threads are kept until process exit
+        std::vector<std::shared_ptr<ThreadBuffer> > buffers{};
+    };
+
+    TraceRegistry &registry() {
+        static TraceRegistry registry{};
+        return registry;
+    }
+
+    ThreadBuffer &thread_buffer() {
+        thread_local std::shared_ptr<ThreadBuffer> buffer = [] {
+            auto created = std::make_shared<ThreadBuffer>(static_cast<uint64_t>(syscall(SYS_gettid)));
+            auto &r = registry();
+            std::lock_guard<std::mutex> locker(r.mutex);
+            r.buffers.emplace_back(created);
+            return created;
+        }();
+        return *buffer;
+    }
+
+    struct Copied {
+        const char *name;
+        uint64_t start_ns;
+        uint64_t end_ns;
+    };
+
+    std::vector<Copied> copy_events(const ThreadBuffer &buffer) {
+        auto head = buffer.head.load(std::memory_order_acquire);
+        auto first = head > pie::trace::thread_capacity ? head - pie::trace::thread_capacity : 0;
+        std::vector<Copied> copied{};
+        copied.reserve(static_cast<size_t>(head - first));
+        for (auto i = first; i < head; ++i) {
+            const auto &event = buffer.events[i & (pie::trace::thread_capacity - 1)];
+            copied.push_back({
+                event.name.load(std::memory_order_relaxed),
+                event.start_ns.load(std::memory_order_relaxed),
+                event.end_ns.load(std::memory_order_relaxed)
+            });
+        }
+
+        // drop events owner thread could overwrite while they were copied
+        auto new_head = buffer.head.load(std::memory_order_acquire);
+        auto overwritten = new_head > pie::trace::thread_capacity ? new_head - pie::trace::thread_capacity : 0;
+        if (overwritten > first)
+            copied.erase(copied.begin(), copied.begin() + static_cast<std::ptrdiff_t>(
+                                                               std::min<uint64_t>(overwritten - first, copied.size())));
+
+        return copied;
+    }
+
+    void write_escaped(std::FILE *out, const std::string &value) {
+        for (auto c: value) {
+            if (c == '"' || c == '\\')
+                std::fputc('\\', out);
+
+            if (static_cast<unsigned char>(c) >= 0x20)
+                std::fputc(c, out);
+        }
+    }
+}
+
+namespace pie::trace {
+    uint64_t now_ns() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    void record(const char *name, uint64_t start_ns, uint64_t end_ns) {
+        auto &buffer = thread_buffer();
+        auto head = buffer.head.load(std::memory_order_relaxed);
+        auto &event = buffer.events[head & (thread_capacity - 1)];
+        event.name.store(name, std::memory_order_relaxed);
+        event.start_ns.store(start_ns, std::memory_order_relaxed);
+        event.end_ns.store(end_ns, std::memory_order_relaxed);
+        buffer.head.store(head + 1, std::memory_order_release);
+    }
+
+    void thread_name(const std::string &name) {
+        auto &buffer = thread_buffer();
+        std::lock_guard<std::mutex> locker(registry().mutex);
+        buffer.name = name;
+    }
+
+    size_t dump(const std::string &file) {
+        auto out = std::fopen(file.c_str(), "w");
+        if (!out)
+            throw std::runtime_error("Failed to open trace file: " + file);
+
+        size_t written{0};
+        auto failed{false};
+        try {
+            written = dump(out);
+        } catch (const std::runtime_error &) {
+            failed = true;
+        }
+
+        if (std::fclose(out) != 0 || failed)
+            throw std::runtime_error("Failed to write trace file: " + file);
+
+        return written;
+    }
+
+    size_t dump(std::FILE *out) {
+        std::vector<std::shared_ptr<ThreadBuffer> > buffers{};
+        {
+            auto &r = registry();
+            std::lock_guard<std::mutex> locker(r.mutex);
+            buffers = r.buffers;
+        }
+
+        auto pid = static_cast<long>(getpid());
+        size_t written{0};
+        std::fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n", out);
+        auto separator = "";
+        for (const auto &buffer: buffers) {
+            std::string name{};
+            {
+                std::lock_guard<std::mutex> locker(registry().mutex);
+                name = buffer->name.empty() ? "thread " + std::to_string(buffer->tid) : buffer->name;
+            }
+
+            std::fprintf(out, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%ld,\"tid\":%llu,\"args\":{\"name\":\"",
+                         separator, pid, static_cast<unsigned long long>(buffer->tid));
+            write_escaped(out, name);
+            std::fputs("\"}}", out);
+            separator = ",\n";
+
+            for (const auto &event: copy_events(*buffer)) {
+                std::fprintf(out, ",\n{\"name\":\"");
+                write_escaped(out, event.name ? event.name : "");
+                std::fprintf(out, "\",\"ph\":\"X\",\"pid\":%ld,\"tid\":%llu,\"ts\":%.3f,\"dur\":%.3f}",
+                             pid, static_cast<unsigned long long>(buffer->tid),
+                             static_cast<double>(event.start_ns) / 1000.0,
+                             static_cast<double>(event.end_ns - event.start_ns) / 1000.0);
+                ++written;
+            }
+        }
+
+        std::fputs("\n]}\n", out);
+        if (std::fflush(out) != 0 || std::ferror(out) != 0)
+            throw std::runtime_error("Failed to write trace");
+
+        return written;
+    }
+}
@@ -0,0 +1,104 @@
+/**
+* @file Trace.h
+* @author Ilija Poznic
+* @date 2025
+*
+* Scoped trace spans stored in per-thread rings and dumped as Chrome trace event JSON
+* (chrome://tracing, ui.perfetto.dev). Enabled with PIE_ENABLE_TRACE, otherwise macros expand to nothing:
+*
+*     PIE_TRACE_SCOPE("DBus::flush");
+*     dbus_connection_flush(conn);
+*
+* Span name must be a string literal (only pointer is stored).
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace pie::trace {
+#ifdef PIE_ENABLE_TRACE
+    inline constexpr bool compiled = true;
+#else
+    inline constexpr bool compiled = false;
+#endif
+
+    /**
+     * Number of spans kept per thread, older spans are overwritten
+     */
+    inline constexpr size_t thread_capacity{size_t{1} << 15};
+
+    namespace detail {
+        inline std::atomic<bool> enabled{true};
+    }
+
+    /**
+     * Runtime switch, spans are recorded only if compiled in and enabled
+     */
+    inline bool enabled() {
+        return detail::enabled.load(std::memory_order_relaxed);
+    }
+
+    inline void enabled(bool set) {
+        detail::enabled.store(set, std::memory_order_relaxed);
+    }
+
+    uint64_t now_ns();
+
+    /**
+     * Append span to ring of calling thread. Lock-free, ring is allocated on first call in thread.
+     */
+    void record(const char *name, uint64_t start_ns, uint64_t end_ns);
+
+    /**
+     * Name of calling thread in dumped trace
+     */
+    void thread_name(const std::string &name);
+
+    /**
+     * Write spans of all threads as Chrome trace event JSON. Spans are read without stopping writers,
+     * spans overwritten while reading are skipped.
+     * @return number of written spans
+     * @throws std::runtime_error if file can not be written
+     */
+    size_t dump(const std::string &file);
+
+    /**
+     * Same as dump to file, out is left open
+     */
+    size_t dump(std::FILE *out);
+
+    class Span {
+    public:
+        explicit Span(const char *name) : name(enabled() ? name : nullptr), start_ns(this->name ? now_ns() : 0) {
+        }
+
+        ~Span() {
+            if (name)
+                record(name, start_ns, now_ns());
+        }
+
+        Span(const Span &) = delete;
+
+        Span &operator=(const Span &) = delete;
+
+    private:
+        const char *name;
+        uint64_t start_ns;
+    };
+}
+
+#define PIE_TRACE_CONCAT_(a, b) a##b
+#define PIE_TRACE_CONCAT(a, b) PIE_TRACE_CONCAT_(a, b)
+
+#ifdef PIE_ENABLE_TRACE
+#define PIE_TRACE_SCOPE(name) const pie::trace::Span PIE_TRACE_CONCAT(pie_trace_span_, __LINE__){name}
+#define PIE_TRACE_THREAD_NAME(name) pie::trace::thread_name(name)
+#else
+#define PIE_TRACE_SCOPE(name) static_cast<void>(0)
+#define PIE_TRACE_THREAD_NAME(name) static_cast<void>(0)
+#endif
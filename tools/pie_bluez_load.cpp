@@ -0,0 +1,725 @@
+/**
+* @file pie_bluez_load.cpp
+* @author Ilija Poznic
+* @date 2025
+*
+* BlueZ stand-in load generator. Starts private dbus-daemon, owns org.bluez and accepts
+* GattManager1.RegisterApplication and LEAdvertisingManager1.RegisterAdvertisement on /org/bluez/hci0.
+* Registered application is read with GetManagedObjects, then its first writable characteristic
+* (or the one with --uuid) is flooded with WriteValue calls. Throughput and end-to-end latency
+* (scheduled send -> method return) are printed as JSON.
+* With --mode acquire the characteristic socket is taken with AcquireWrite (as bluetoothd does when
+* WriteAcquired property is present) and packets are sent to it, only throughput is printed.
+*
+* Usage: pie_bluez_load [--rate <calls/s, 0 - as fast as window allows>] [--size <bytes>] [--devices <n>]
+*                       [--duration <s>] [--window <max calls in flight>] [--uuid <characteristic uuid>]
+*                       [--mode <write|acquire>] [--address <dbus address, no private daemon>]
+*                       [-- <application> <args>]
+*
+* Application args "{address}" are replaced with bus address, its stdout is discarded and ENTER is sent
+* to its stdin at the end, e.g.:
+*
+*     pie_bluez_load --rate 2000 --size 20 -- ./cpp_bluez_dbus_tx_example {address} /tmp/pie.bin
+*/
+
+#include "pie/bluez/gatt/helper/characteristic.h"
+#include "pie/bluez/gatt/helper/manager.h"
+#include "pie/bluez/helper/bluez.h"
+#include "pie/bluez/helper/le_advertising_manager.h"
+#include "pie/dbus/helper/dbus.h"
+
+#include <dbus/dbus.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+    using namespace std::chrono_literals;
+
+    constexpr auto register_timeout{10s};
+    constexpr auto drain_timeout{2s};
+    constexpr auto app_exit_timeout{5s};
+
+    struct Options {
+        uint64_t rate{0};
+        size_t size{20};
+        size_t devices{1};
+        double duration_s{5.0};
+        size_t window{64};
+        std::string uuid{};
+        // write - WriteValue calls, acquire - packets to AcquireWrite socket
+        std::string mode{"write"};
+        std::string address{};
+        std::vector<std::string> app{};
+    };
+
+    Options parse_options(int argc, char **argv) {
+        Options options{};
+        for (int i = 1; i < argc; ++i) {
+            std::string arg{argv[i]};
+            if (arg == "--") {
+                options.app.assign(argv + i + 1, argv + argc);
+                break;
+            }
+
+            if (i + 1 >= argc)
+                throw std::invalid_argument("Missing value of " + arg);
+
+            std::string value{argv[++i]};
+            if (arg == "--rate")
+                options.rate = std::stoull(value);
+            else if (arg == "--size")
+                options.size = std::stoul(value);
+            else if (arg == "--devices")
+                options.devices = std::max<size_t>(1, std::stoul(value));
+            else if (arg == "--duration")
+                options.duration_s = std::stod(value);
+            else if (arg == "--window")
+                options.window = std::max<size_t>(1, std::stoul(value));
+            else if (arg == "--uuid")
+                options.uuid = value;
+            else if (arg == "--mode" && (value == "write" || value == "acquire"))
+                options.mode = value;
+            else if (arg == "--address")
+                options.address = value;
+            else
+                throw std::invalid_argument("Unknown option " + arg);
+        }
+
+        return options;
+    }
+
+    /**
+     * Child process, stopped with SIGTERM when object is destroyed
+     */
+    class Process {
+    public:
+        /**
+         * @param stdin_fd - if not null, set to write end of pipe connected to child stdin
+         * @param quiet - child stdout goes to /dev/null
+         */
+        Process(const std::vector<std::string> &args, int *stdin_fd, bool quiet, int print_fd = -1) {
+            int fds[2]{-1, -1};
+            if (stdin_fd && pipe(fds) != 0)
+                throw std::runtime_error("pipe failed");
+
+            pid = fork();
+            if (pid < 0)
+                throw std::runtime_error("fork failed");
+
+            if (pid == 0) {
+                if (stdin_fd) {
+                    dup2(fds[0], STDIN_FILENO);
+                    close(fds[0]);
+                    close(fds[1]);
+                }
+
+                if (quiet) {
+                    auto null_fd = open("/dev/null", O_WRONLY);
+                    dup2(null_fd, STDOUT_FILENO);
+                    close(null_fd);
+                }
+
+                std::vector<char *> argv{};
+                for (const auto &arg: args)
+                    argv.push_back(const_cast<char *>(arg.c_str()));
+                argv.push_back(nullptr);
+                execv(argv[0], argv.data());
+                _exit(127);
+            }
+
+            if (print_fd >= 0)
+                close(print_fd);
+
+            if (stdin_fd) {
+                close(fds[0]);
+                *stdin_fd = fds[1];
+            }
+        }
+
+        ~Process() {
+            if (pid > 0 && !exited()) {
+                kill(pid, SIGTERM);
+                waitpid(pid, nullptr, 0);
+            }
+        }
+
+        Process(const Process &) = delete;
+
+        Process &operator=(const Process &) = delete;
+
+        bool exited() {
+            if (pid <= 0)
+                return true;
+
+            if (waitpid(pid, nullptr, WNOHANG) != pid)
+                return false;
+
+            pid = -1;
+            return true;
+        }
+
+    private:
+        pid_t pid{-1};
+    };
+
+    /**
+     * dbus-daemon --session on a private socket
+     */
+    std::unique_ptr<Process> start_daemon(std::string &address) {
+        int fds[2];
+        if (pipe(fds) != 0)
+            throw std::runtime_error("pipe failed");
+
+        auto daemon = std::make_unique<Process>(
+            std::vector<std::string>{
+                PIE_DBUS_DAEMON, "--session", "--nofork", "--print-address=" + std::to_string(fds[1])
+            }, nullptr, false, fds[1]);
+
+        char ch{0};
+        while (read(fds[0], &ch, 1) == 1 && ch != '\n')
+            address.push_back(ch);
+
+        close(fds[0]);
+        if (address.empty())
+            throw std::runtime_error(std::string{"failed to start "} + PIE_DBUS_DAEMON);
+
+        return daemon;
+    }
+
+    struct Target {
+        std::string path;
+        std::string uuid;
+        bool writable{false};
+        bool write_acquired{false};
+    };
+
+    /**
+     * org.bluez stand-in, all calls are handled on the calling thread by pump()
+     */
+    class BluezStandIn {
+    public:
+        explicit BluezStandIn(const std::string &address) {
+            DBusError error{};
+            dbus_error_init(&error);
+            conn = dbus_connection_open_private(address.c_str(), &error);
+            if (!conn || !dbus_bus_register(conn, &error))
+                throw std::runtime_error("failed to connect to " + address);
+
+            auto owner = dbus_bus_request_name(conn, pie::bluez::bus_name, DBUS_NAME_FLAG_DO_NOT_QUEUE, &error);
+            dbus_error_free(&error);
+            if (owner != DBUS_REQUEST_NAME_REPLY_PRIMARY_OWNER)
+                throw std::runtime_error(std::string{"failed to own "} + pie::bluez::bus_name);
+        }
+
+        ~BluezStandIn() {
+            dbus_connection_close(conn);
+            dbus_connection_unref(conn);
+        }
+
+        BluezStandIn(const BluezStandIn &) = delete;
+
+        BluezStandIn &operator=(const BluezStandIn &) = delete;
+
+        /**
+         * Send queued messages, wait up to timeout_ms for incoming ones and handle all of them
+         */
+        void pump(int timeout_ms) {
+            dbus_connection_read_write(conn, timeout_ms);
+            while (auto msg = dbus_connection_pop_message(conn)) {
+                handle(msg);
+                dbus_message_unref(msg);
+            }
+        }
+
+        [[nodiscard]] bool has_targets() const {
+            return objects_received;
+        }
+
+        [[nodiscard]] const std::vector<Target> &targets() const {
+            return targets_;
+        }
+
+        /**
+         * WriteValue(ay value, a{sv} options) as sent by bluetoothd for write without response
+         * @return serial, 0 if not sent
+         */
+        uint32_t write_value(const std::string &path, size_t size, size_t device, uint64_t sequence) {
+            auto msg = dbus_message_new_method_call(
+                app_owner.c_str(), path.c_str(), pie::bluez::gatt::characteristic::iface,
+                pie::bluez::gatt::characteristic::to_string(
+                    pie::bluez::gatt::characteristic::Methods::WriteValue).c_str());
+            if (!msg)
+                return 0;
+
+            std::vector<uint8_t> value(size, 0);
+            std::memcpy(value.data(), &sequence, std::min(size, sizeof(sequence)));
+            auto p_value = value.data();
+            DBusMessageIter iter{nullptr};
+            dbus_message_iter_init_append(msg, &iter);
+            DBusMessageIter arr_iter{nullptr};
+            dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY, DBUS_TYPE_BYTE_AS_STRING, &arr_iter);
+            dbus_message_iter_append_fixed_array(&arr_iter, DBUS_TYPE_BYTE, &p_value, static_cast<int>(size));
+            dbus_message_iter_close_container(&iter, &arr_iter);
+
+            dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY, "{sv}", &arr_iter);
+            pie::dbus::message_append_dict_entry_object(&arr_iter, "device", device_path(device));
+            pie::dbus::message_append_dict_entry(&arr_iter, "link", std::string{"LE"});
+            pie::dbus::message_append_dict_entry(&arr_iter, "type", std::string{"command"});
+            dbus_message_iter_close_container(&iter, &arr_iter);
+
+            uint32_t serial{0};
+            if (!dbus_connection_send(conn, msg, &serial))
+                serial = 0;
+
+            dbus_message_unref(msg);
+            return serial;
+        }
+
+        /**
+         * AcquireWrite(a{sv} options) as sent by bluetoothd on first write command of a device,
+         * reply is read by pump()
+         */
+        void acquire_write(const std::string &path, uint16_t mtu) {
+            auto msg = dbus_message_new_method_call(
+                app_owner.c_str(), path.c_str(), pie::bluez::gatt::characteristic::iface,
+                pie::bluez::gatt::characteristic::to_string(
+                    pie::bluez::gatt::characteristic::Methods::AcquireWrite).c_str());
+            DBusMessageIter iter{nullptr};
+            dbus_message_iter_init_append(msg, &iter);
+            DBusMessageIter arr_iter{nullptr};
+            dbus_message_iter_open_container(&iter, DBUS_TYPE_ARRAY, "{sv}", &arr_iter);
+            pie::dbus::message_append_dict_entry_object(&arr_iter, "device", device_path(0));
+            pie::dbus::message_append_dict_entry(&arr_iter, "link", std::string{"LE"});
+            append_dict_entry_uint16(&arr_iter, "mtu", mtu);
+            dbus_message_iter_close_container(&iter, &arr_iter);
+            dbus_connection_send(conn, msg, &acquire_serial);
+            dbus_message_unref(msg);
+        }
+
+        [[nodiscard]] bool acquire_replied() const {
+            return acquire_received;
+        }
+
+        /**
+         * Socket returned by AcquireWrite, -1 if call failed. Owned by caller.
+         */
+        [[nodiscard]] int acquired_fd() const {
+            return acquired_fd_;
+        }
+
+        [[nodiscard]] uint16_t acquired_mtu() const {
+            return acquired_mtu_;
+        }
+
+        /**
+         * Called for method return or error of write_value call
+         */
+        std::function<void(uint32_t reply_serial, bool is_error)> on_reply{};
+
+    private:
+        DBusConnection *conn{nullptr};
+        std::string app_owner{};
+        std::string app_path{};
+        uint32_t objects_serial{0};
+        bool objects_received{false};
+        std::vector<Target> targets_{};
+        uint32_t acquire_serial{0};
+        bool acquire_received{false};
+        int acquired_fd_{-1};
+        uint16_t acquired_mtu_{0};
+
+        static std::string device_path(size_t device) {
+            char path[64];
+            std::snprintf(path, sizeof(path), "%s/dev_00_00_00_00_%02X_%02X",
+                          pie::bluez::path_org_bluez_hci0, static_cast<unsigned>((device >> 8) & 0xff),
+                          static_cast<unsigned>(device & 0xff));
+            return path;
+        }
+
+        static void append_dict_entry_uint16(DBusMessageIter *iter, const char *key, uint16_t value) {
+            DBusMessageIter dict_iter{nullptr};
+            dbus_message_iter_open_container(iter, DBUS_TYPE_DICT_ENTRY, nullptr, &dict_iter);
+            dbus_message_iter_append_basic(&dict_iter, DBUS_TYPE_STRING, &key);
+            DBusMessageIter var_iter{nullptr};
+            dbus_message_iter_open_container(&dict_iter, DBUS_TYPE_VARIANT, DBUS_TYPE_UINT16_AS_STRING, &var_iter);
+            dbus_message_iter_append_basic(&var_iter, DBUS_TYPE_UINT16, &value);
+            dbus_message_iter_close_container(&dict_iter, &var_iter);
+            dbus_message_iter_close_container(iter, &dict_iter);
+        }
+
+        void read_acquired(DBusMessage *msg) {
+            acquire_received = true;
+            if (dbus_message_get_type(msg) == DBUS_MESSAGE_TYPE_ERROR) {
+                std::cerr << "AcquireWrite failed: " << dbus_message_get_error_name(msg) << std::endl;
+                return;
+            }
+
+            int fd{-1};
+            if (dbus_message_get_args(msg, nullptr, DBUS_TYPE_UNIX_FD, &fd, DBUS_TYPE_UINT16, &acquired_mtu_,
+                                      DBUS_TYPE_INVALID))
+                acquired_fd_ = fd;
+        }
+
+        void reply(DBusMessage *msg) {
+            auto reply = dbus_message_new_method_return(msg);
+            dbus_connection_send(conn, reply, nullptr);
+            dbus_message_unref(reply);
+        }
+
+        void handle(DBusMessage *msg) {
+            auto type = dbus_message_get_type(msg);
+            if (type == DBUS_MESSAGE_TYPE_METHOD_RETURN || type == DBUS_MESSAGE_TYPE_ERROR) {
+                auto reply_serial = dbus_message_get_reply_serial(msg);
+                if (reply_serial == objects_serial && objects_serial != 0)
+                    read_objects(msg);
+                else if (reply_serial == acquire_serial && acquire_serial != 0)
+                    read_acquired(msg);
+                else if (on_reply)
+                    on_reply(reply_serial, type == DBUS_MESSAGE_TYPE_ERROR);
+                return;
+            }
+
+            if (type != DBUS_MESSAGE_TYPE_METHOD_CALL || dbus_message_get_no_reply(msg))
+                return;
+
+            auto register_application = pie::bluez::gatt::manager::to_string(
+                pie::bluez::gatt::manager::Methods::RegisterApplication);
+            auto unregister_application = pie::bluez::gatt::manager::to_string(
+                pie::bluez::gatt::manager::Methods::UnregisterApplication);
+            if (dbus_message_is_method_call(msg, pie::bluez::gatt::manager::iface, register_application.c_str())) {
+                const char *path{nullptr};
+                if (dbus_message_get_args(msg, nullptr, DBUS_TYPE_OBJECT_PATH, &path, DBUS_TYPE_INVALID)) {
+                    app_owner = dbus_message_get_sender(msg);
+                    app_path = path;
+                    reply(msg);
+                    request_objects();
+                    return;
+                }
+            } else if (dbus_message_is_method_call(msg, pie::bluez::gatt::manager::iface,
+                                                   unregister_application.c_str()) ||
+                       dbus_message_is_method_call(msg, pie::bluez::le_advertising_manager::iface,
+                                                   "RegisterAdvertisement") ||
+                       dbus_message_is_method_call(msg, pie::bluez::le_advertising_manager::iface,
+                                                   "UnregisterAdvertisement")) {
+                reply(msg);
+                return;
+            }
+
+            auto error = dbus_message_new_error(msg, DBUS_ERROR_UNKNOWN_METHOD, "Not implemented by stand-in");
+            dbus_connection_send(conn, error, nullptr);
+            dbus_message_unref(error);
+        }
+
+        void request_objects() {
+            auto msg = dbus_message_new_method_call(app_owner.c_str(), app_path.c_str(),
+                                                    pie::dbus::object_manager::iface,
+                                                    pie::dbus::object_manager::to_string(
+                                                        pie::dbus::object_manager::Methods::GetManagedObject).c_str());
+            dbus_connection_send(conn, msg, &objects_serial);
+            dbus_message_unref(msg);
+        }
+
+        /**
+         * a{oa{sa{sv}}}, only UUID and Flags of GattCharacteristic1 are read
+         */
+        void read_objects(DBusMessage *msg) {
+            objects_received = true;
+            DBusMessageIter iter{nullptr};
+            if (!dbus_message_iter_init(msg, &iter) || dbus_message_iter_get_arg_type(&iter) != DBUS_TYPE_ARRAY)
+                return;
+
+            DBusMessageIter objects_iter{nullptr};
+            for (dbus_message_iter_recurse(&iter, &objects_iter);
+                 dbus_message_iter_get_arg_type(&objects_iter) == DBUS_TYPE_DICT_ENTRY;
+                 dbus_message_iter_next(&objects_iter)) {
+                DBusMessageIter object_iter{nullptr};
+                dbus_message_iter_recurse(&objects_iter, &object_iter);
+                const char *path{nullptr};
+                dbus_message_iter_get_basic(&object_iter, &path);
+                dbus_message_iter_next(&object_iter);
+
+                DBusMessageIter ifaces_iter{nullptr};
+                for (dbus_message_iter_recurse(&object_iter, &ifaces_iter);
+                     dbus_message_iter_get_arg_type(&ifaces_iter) == DBUS_TYPE_DICT_ENTRY;
+                     dbus_message_iter_next(&ifaces_iter)) {
+                    DBusMessageIter iface_iter{nullptr};
+                    dbus_message_iter_recurse(&ifaces_iter, &iface_iter);
+                    const char *iface{nullptr};
+                    dbus_message_iter_get_basic(&iface_iter, &iface);
+                    if (std::strcmp(iface, pie::bluez::gatt::characteristic::iface) != 0)
+                        continue;
+
+                    dbus_message_iter_next(&iface_iter);
+                    targets_.emplace_back(read_characteristic(path, &iface_iter));
+                }
+            }
+        }
+
+        static Target read_characteristic(const char *path, DBusMessageIter *props) {
+            Target target{path};
+            DBusMessageIter props_iter{nullptr};
+            for (dbus_message_iter_recurse(props, &props_iter);
+                 dbus_message_iter_get_arg_type(&props_iter) == DBUS_TYPE_DICT_ENTRY;
+                 dbus_message_iter_next(&props_iter)) {
+                DBusMessageIter prop_iter{nullptr};
+                dbus_message_iter_recurse(&props_iter, &prop_iter);
+                const char *name{nullptr};
+                dbus_message_iter_get_basic(&prop_iter, &name);
+                dbus_message_iter_next(&prop_iter);
+                DBusMessageIter var_iter{nullptr};
+                dbus_message_iter_recurse(&prop_iter, &var_iter);
+                if (std::strcmp(name, "UUID") == 0 && dbus_message_iter_get_arg_type(&var_iter) == DBUS_TYPE_STRING) {
+                    const char *uuid{nullptr};
+                    dbus_message_iter_get_basic(&var_iter, &uuid);
+                    target.uuid = uuid;
+                } else if (std::strcmp(name, "Flags") == 0 &&
+                           dbus_message_iter_get_arg_type(&var_iter) == DBUS_TYPE_ARRAY) {
+                    DBusMessageIter flags_iter{nullptr};
+                    for (dbus_message_iter_recurse(&var_iter, &flags_iter);
+                         dbus_message_iter_get_arg_type(&flags_iter) == DBUS_TYPE_STRING;
+                         dbus_message_iter_next(&flags_iter)) {
+                        const char *flag{nullptr};
+                        dbus_message_iter_get_basic(&flags_iter, &flag);
+                        if (std::strcmp(flag, "write") == 0 || std::strcmp(flag, "write-without-response") == 0)
+                            target.writable = true;
+                    }
+                } else if (std::strcmp(name, "WriteAcquired") == 0) {
+                    target.write_acquired = true;
+                }
+            }
+
+            return target;
+        }
+    };
+
+    double percentile(const std::vector<double> &sorted, double p) {
+        if (sorted.empty())
+            return 0.0;
+
+        return sorted[static_cast<size_t>(p / 100.0 * static_cast<double>(sorted.size() - 1))];
+    }
+
+    struct Load {
+        uint64_t sent{0};
+        uint64_t replies{0};
+        uint64_t errors{0};
+        uint64_t send_failures{0};
+        std::unordered_map<uint32_t, Clock::time_point> in_flight{};
+        std::vector<double> latencies_us{};
+    };
+
+    /**
+     * With rate, calls are scheduled at fixed interval and latency is measured from scheduled time,
+     * so time spent waiting for free window is included (no coordinated omission)
+     */
+    void run_load(BluezStandIn &bluez, const Options &options, const Target &target, Load &load) {
+        bluez.on_reply = [&load](uint32_t reply_serial, bool is_error) {
+            auto it = load.in_flight.find(reply_serial);
+            if (it == load.in_flight.end())
+                return;
+
+            load.latencies_us.push_back(
+                std::chrono::duration<double, std::micro>(Clock::now() - it->second).count());
+            load.in_flight.erase(it);
+            ++(is_error ? load.errors : load.replies);
+        };
+
+        auto start = Clock::now();
+        auto end = start + std::chrono::duration_cast<Clock::duration>(
+                               std::chrono::duration<double>(options.duration_s));
+        auto interval = options.rate == 0
+                            ? Clock::duration::zero()
+                            : std::chrono::duration_cast<Clock::duration>(1s) / static_cast<Clock::rep>(options.rate);
+        auto next = start;
+        for (auto now = start; now < end; now = Clock::now()) {
+            while (load.in_flight.size() < options.window && next <= now && next < end) {
+                auto scheduled = options.rate == 0 ? now : next;
+                auto serial = bluez.write_value(target.path, options.size, load.sent % options.devices, load.sent);
+                ++load.sent;
+                if (serial == 0)
+                    ++load.send_failures;
+                else
+                    load.in_flight.emplace(serial, scheduled);
+
+                next = options.rate == 0 ? now : next + interval;
+            }
+
+            auto wait_ms = 0;
+            if (load.in_flight.size() >= options.window)
+                wait_ms = 1;
+            else if (options.rate != 0 && next > now)
+                wait_ms = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(next - now).count());
+            bluez.pump(wait_ms);
+        }
+
+        auto drain_end = Clock::now() + drain_timeout;
+        while (!load.in_flight.empty() && Clock::now() < drain_end)
+            bluez.pump(10);
+
+        auto elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        auto &samples = load.latencies_us;
+        std::sort(samples.begin(), samples.end());
+        auto completed = static_cast<double>(load.replies + load.errors);
+        std::cout << "{\"uuid\": \"" << target.uuid << "\", \"path\": \"" << target.path << "\""
+                << ", \"rate\": " << options.rate << ", \"size\": " << options.size
+                << ", \"devices\": " << options.devices << ", \"window\": " << options.window
+                << ", \"sent\": " << load.sent << ", \"replies\": " << load.replies
+                << ", \"errors\": " << load.errors << ", \"lost\": " << load.in_flight.size() + load.send_failures
+                << ", \"duration_s\": " << elapsed
+                << ", \"calls_per_s\": " << completed / elapsed
+                << ", \"payload_bytes_per_s\": " << completed * static_cast<double>(options.size) / elapsed
+                << ", \"p50_us\": " << percentile(samples, 50) << ", \"p90_us\": " << percentile(samples, 90)
+                << ", \"p99_us\": " << percentile(samples, 99) << ", \"p999_us\": " << percentile(samples, 99.9)
+                << ", \"max_us\": " << (samples.empty() ? 0.0 : samples.back()) << "}" << std::endl;
+    }
+
+    /**
+     * Packets are sent at fixed interval (or as fast as socket accepts), full socket is waited for,
+     * so delivered packets are bounded by application read speed
+     */
+    void run_acquired_load(BluezStandIn &bluez, const Options &options, const Target &target) {
+        bluez.acquire_write(target.path, static_cast<uint16_t>(std::min<size_t>(options.size + 3, 517)));
+        auto acquire_end = Clock::now() + register_timeout;
+        while (!bluez.acquire_replied() && Clock::now() < acquire_end)
+            bluez.pump(10);
+
+        auto fd = bluez.acquired_fd();
+        if (fd < 0)
+            throw std::runtime_error("AcquireWrite did not return socket");
+
+        uint64_t sent{0};
+        uint64_t send_failures{0};
+        uint64_t full_waits{0};
+        std::vector<uint8_t> value(options.size, 0);
+        auto start = Clock::now();
+        auto end = start + std::chrono::duration_cast<Clock::duration>(
+                               std::chrono::duration<double>(options.duration_s));
+        auto interval = options.rate == 0
+                            ? Clock::duration::zero()
+                            : std::chrono::duration_cast<Clock::duration>(1s) / static_cast<Clock::rep>(options.rate);
+        auto next = start;
+        for (auto now = start; now < end; now = Clock::now()) {
+            if (next > now) {
+                bluez.pump(static_cast<int>(
+                    std::chrono::duration_cast<std::chrono::milliseconds>(next - now).count()));
+                continue;
+            }
+
+            std::memcpy(value.data(), &sent, std::min(options.size, sizeof(sent)));
+            auto cnt = send(fd, value.data(), value.size(), MSG_DONTWAIT | MSG_NOSIGNAL);
+            if (cnt < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                ++full_waits;
+                pollfd poll_fd{fd, POLLOUT, 0};
+                poll(&poll_fd, 1, 10);
+                continue;
+            }
+
+            if (cnt < 0) {
+                ++send_failures;
+                break;
+            }
+
+            ++sent;
+            next = options.rate == 0 ? now : next + interval;
+        }
+
+        auto elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        close(fd);
+        std::cout << "{\"uuid\": \"" << target.uuid << "\", \"path\": \"" << target.path << "\""
+                << ", \"mode\": \"acquire\", \"mtu\": " << bluez.acquired_mtu()
+                << ", \"rate\": " << options.rate << ", \"size\": " << options.size
+                << ", \"sent\": " << sent << ", \"send_failures\": " << send_failures
+                << ", \"full_waits\": " << full_waits << ", \"duration_s\": " << elapsed
+                << ", \"packets_per_s\": " << static_cast<double>(sent) / elapsed
+                << ", \"payload_bytes_per_s\": " << static_cast<double>(sent * options.size) / elapsed
+                << "}" << std::endl;
+    }
+
+    const Target *select_target(const BluezStandIn &bluez, const Options &options) {
+        for (const auto &target: bluez.targets()) {
+            auto usable = options.mode == "acquire" ? target.write_acquired : target.writable;
+            if (options.uuid.empty() ? usable : target.uuid == options.uuid)
+                return &target;
+        }
+
+        return nullptr;
+    }
+}
+
+int main(int argc, char **argv) {
+    signal(SIGPIPE, SIG_IGN);
+    try {
+        auto options = parse_options(argc, argv);
+        std::unique_ptr<Process> daemon{};
+        auto address = options.address;
+        if (address.empty())
+            daemon = start_daemon(address);
+
+        std::cerr << "bus address: " << address << std::endl;
+        BluezStandIn bluez{address};
+
+        std::unique_ptr<Process> app{};
+        int app_stdin{-1};
+        if (!options.app.empty()) {
+            for (auto &arg: options.app) {
+                if (arg == "{address}")
+                    arg = address;
+            }
+
+            app = std::make_unique<Process>(options.app, &app_stdin, true);
+        }
+
+        auto register_end = Clock::now() + register_timeout;
+        while (!bluez.has_targets() && Clock::now() < register_end)
+            bluez.pump(10);
+
+        auto target = select_target(bluez, options);
+        if (!target) {
+            std::cerr << (bluez.has_targets() ? "no matching characteristic" : "no application registered")
+                    << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        if (options.mode == "acquire") {
+            run_acquired_load(bluez, options, *target);
+        } else {
+            Load load{};
+            run_load(bluez, options, *target, load);
+        }
+
+        if (app) {
+            // application exits on ENTER, it unregisters through stand-in which must keep answering
+            if (write(app_stdin, "\n", 1) != 1)
+                std::cerr << "failed to stop application" << std::endl;
+
+            close(app_stdin);
+            auto exit_end = Clock::now() + app_exit_timeout;
+            while (!app->exited() && Clock::now() < exit_end)
+                bluez.pump(10);
+        }
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,133 @@
+/**
+* @file pie_log_decode.cpp
+* @author Ilija Poznic
+* @date 2025
+*
+* Decode BinaryLogger file to text, oldest record first.
+*
+* Usage: pie_log_decode <binary log file>
+*/
+
+#include "pie/logging/binary_log_format.h"
+#include "pie/logging/ConsoleLogger_ostream_helper.h"
+#include "pie/logging/LogFormat.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+    namespace binary_log = pie::logging::binary_log;
+
+    struct Format {
+        std::string tag;
+        std::string format;
+    };
+
+    std::unordered_map<uint16_t, Format> read_formats(const std::vector<uint8_t> &file,
+                                                      const binary_log::FileHeader &header) {
+        std::unordered_map<uint16_t, Format> formats{};
+        size_t offset{0};
+        while (offset + sizeof(binary_log::FormatEntry) <= header.formats_size) {
+            binary_log::FormatEntry entry{};
+            auto p_entry = file.data() + header.formats_offset + offset;
+            std::memcpy(&entry, p_entry, sizeof(entry));
+            auto text = reinterpret_cast<const char *>(p_entry + sizeof(entry));
+            formats[entry.id] = Format{
+                std::string(text, entry.tag_size),
+                std::string(text + entry.tag_size, entry.format_size)
+            };
+            offset += binary_log::align8(sizeof(entry) + entry.tag_size + entry.format_size);
+        }
+
+        return formats;
+    }
+
+    void print_timestamp(std::ostream &os, uint64_t timestamp_ns) {
+        auto seconds = static_cast<time_t>(timestamp_ns / 1000000000);
+        std::tm tm{};
+        gmtime_r(&seconds, &tm);
+        os << std::put_time(&tm, "%Y-%m-%dT%H:%M:%S") << "." << std::setw(9) << std::setfill('0')
+                << timestamp_ns % 1000000000 << "Z" << std::setfill(' ');
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " <binary log file>" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::ifstream in{argv[1], std::ios::binary};
+    std::vector<uint8_t> file{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+    binary_log::FileHeader header{};
+    if (file.size() < sizeof(header)) {
+        std::cerr << "Not a binary log file: " << argv[1] << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, binary_log::magic, sizeof(header.magic)) != 0 ||
+        header.version != binary_log::version || header.slot_size != binary_log::slot_size ||
+        header.formats_offset + header.formats_size > file.size() ||
+        header.data_offset + header.data_slots * header.slot_size > file.size()) {
+        std::cerr << "Not a binary log file: " << argv[1] << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    auto formats = read_formats(file, header);
+    auto data = file.data() + header.data_offset;
+    auto end = header.write_slot;
+    auto slot = end > header.data_slots ? end - header.data_slots : 0;
+    uint64_t skipped{0};
+    while (slot < end) {
+        auto index = slot % header.data_slots;
+        binary_log::RecordHeader record{};
+        std::memcpy(&record, data + index * header.slot_size, sizeof(record));
+        // overwritten or not committed record, resync on next slot
+        if (record.slot != slot) {
+            ++skipped;
+            ++slot;
+            continue;
+        }
+
+        if (record.format_id == binary_log::padding_format_id) {
+            slot += header.data_slots - index;
+            continue;
+        }
+
+        auto slots = binary_log::record_slots(record.size);
+        if (index + slots > header.data_slots) {
+            ++skipped;
+            ++slot;
+            continue;
+        }
+
+        print_timestamp(std::cout, record.timestamp_ns);
+        std::cout << " " << record.thread_id << " " << to_short_string(static_cast<pie::LogLevel>(record.level))
+                << " | ";
+        auto args = data + index * header.slot_size + sizeof(record);
+        auto format = formats.find(record.format_id);
+        if (format == formats.end()) {
+            std::cout << "unknown format " << record.format_id << "\n";
+        } else {
+            if (!format->second.tag.empty())
+                std::cout << format->second.tag << "|";
+
+            std::cout << pie::logging::format_record(format->second.format, args, record.size) << "\n";
+        }
+
+        slot += slots;
+    }
+
+    if (skipped > 0)
+        std::cerr << "skipped " << skipped << " incomplete slots" << std::endl;
+
+    return EXIT_SUCCESS;
+}